@@ -0,0 +1,101 @@
+// A bump allocator for data which lives until the end of compilation: the AST,
+// scopes, and types.  Nothing is freed individually; the whole arena is
+// released at once.  Memory is handed out zeroed, from chunks which are a
+// whole number of pages.
+//
+// @Precondition: only used from the main thread.
+
+#define ARENA_CHUNK_SIZE  (64 * 4096)
+#define ARENA_ALIGNMENT   16
+
+typedef struct ArenaChunk {
+  struct ArenaChunk* next;
+  size_t capacity;
+  size_t used;
+  _Alignas(ARENA_ALIGNMENT) char data[];
+} ArenaChunk;
+
+typedef struct {
+  ArenaChunk* chunks;  // Most recent first; only the first is allocated from.
+  size_t allocated;    // Bytes handed out, over the arena's lifetime.
+} Arena;
+
+void initialize_arena(Arena* arena) {
+  arena->chunks = NULL;
+  arena->allocated = 0;
+}
+
+ArenaChunk* _arena_new_chunk(size_t capacity) {
+  ArenaChunk* chunk = calloc(1, sizeof(ArenaChunk) + capacity);
+  chunk->capacity = capacity;
+  return chunk;
+}
+
+void* arena_alloc(Arena* arena, size_t size) {
+  size = (size + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+  arena->allocated += size;
+
+  // Large allocations get a chunk of their own, placed behind the current one
+  // so that its remaining space isn't wasted.
+  if (size > ARENA_CHUNK_SIZE / 4) {
+    ArenaChunk* chunk = _arena_new_chunk(size);
+    chunk->used = size;
+
+    if (arena->chunks == NULL) {
+      arena->chunks = chunk;
+    } else {
+      chunk->next = arena->chunks->next;
+      arena->chunks->next = chunk;
+    }
+    return chunk->data;
+  }
+
+  ArenaChunk* chunk = arena->chunks;
+  if (chunk == NULL || chunk->capacity - chunk->used < size) {
+    chunk = _arena_new_chunk(ARENA_CHUNK_SIZE - sizeof(ArenaChunk));
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+  }
+
+  void* result = chunk->data + chunk->used;
+  chunk->used += size;
+  return result;
+}
+
+// Releases everything allocated so far, keeping one chunk to allocate from
+// again; for arenas holding short-lived data, reused over and over.
+void arena_reset(Arena* arena) {
+  ArenaChunk* kept = NULL;
+
+  ArenaChunk* chunk = arena->chunks;
+  while (chunk != NULL) {
+    ArenaChunk* next = chunk->next;
+    if (kept == NULL && chunk->capacity == ARENA_CHUNK_SIZE - sizeof(ArenaChunk)) {
+      kept = chunk;
+    } else {
+      free(chunk);
+    }
+    chunk = next;
+  }
+
+  if (kept != NULL) {
+    memset(kept->data, 0, kept->used);
+    kept->used = 0;
+    kept->next = NULL;
+  }
+
+  arena->chunks = kept;
+}
+
+void free_arena(Arena* arena) {
+  ArenaChunk* chunk = arena->chunks;
+  while (chunk != NULL) {
+    ArenaChunk* next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+
+  arena->chunks = NULL;
+}
+
+#undef ARENA_ALIGNMENT
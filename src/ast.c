@@ -0,0 +1,122 @@
+// Access to the parts of an AstNode which aren't stored in the node itself.
+
+// The source text a node spans; for literals and type names, this is the text
+// of the token they were parsed from.
+String node_source(String* source, AstNode* node) {
+  return (String) { node->to - node->from, source->data + node->from };
+}
+
+// The error reported at `node`, or NULL if the error (if any) lies further
+// down the tree.
+String* node_error(CompilationWorkspace* ws, AstNode* node) {
+  return id_table_find(&ws->node_errors, node->id);
+}
+
+void node_set_error(CompilationWorkspace* ws, AstNode* node, String* error) {
+  if (error == NULL && id_table_find(&ws->node_errors, node->id) == NULL) return;
+  id_table_add(&ws->node_errors, node->id, error);
+}
+
+
+// ** Flat Layout ** //
+
+// Once a top-level statement has been parsed, its nodes are copied into a
+// single array, so that the later passes walk through one block of memory
+// front to back rather than hopping between wherever the parser left them.
+//
+// Every node precedes its descendants, each node's `body` stays contiguous,
+// and each subtree occupies a contiguous run: a node, then its `lhs` subtree,
+// its `rhs` subtree, its `body`, and finally each `body` node's descendants in
+// turn.  A node's `index` is its position in the array, and its `lhs`, `rhs`
+// and `body` hold the positions of its children.  The statement itself sits at
+// position zero, and is nobody's child, so a zero link means there is none.
+//
+// While the statement is being parsed, links instead hold the numbers the
+// parser gave to their nodes, counting from one; `parsed[n - 1]` is node `n`.
+
+AstNode* _ast_parsed(AstNode** parsed, uint32_t link) {
+  return parsed[link - 1];
+}
+
+uint32_t _ast_count_nodes(AstNode** parsed, AstNode* node) {
+  uint32_t count = 1;
+
+  if (node->lhs) count += _ast_count_nodes(parsed, _ast_parsed(parsed, node->lhs));
+  if (node->rhs) count += _ast_count_nodes(parsed, _ast_parsed(parsed, node->rhs));
+  if (node->body_length == 0) return count;
+
+  AstNode* body = _ast_parsed(parsed, node->body);
+  for (size_t i = 0; i < node->body_length; i++) count += _ast_count_nodes(parsed, &body[i]);
+
+  return count;
+}
+
+uint32_t _ast_flatten_node(AstNode** parsed, AstNode* node, AstNode* nodes, uint32_t* next);
+
+void _ast_flatten_children(AstNode** parsed, AstNode* node, AstNode* nodes, uint32_t* next) {
+  if (node->lhs) node->lhs = _ast_flatten_node(parsed, _ast_parsed(parsed, node->lhs), nodes, next);
+  if (node->rhs) node->rhs = _ast_flatten_node(parsed, _ast_parsed(parsed, node->rhs), nodes, next);
+  if (node->body_length == 0) return;
+
+  AstNode* body = _ast_parsed(parsed, node->body);
+  node->body = *next;
+  *next += node->body_length;
+
+  for (uint32_t i = 0; i < node->body_length; i++) {
+    AstNode* copy = nodes + node->body + i;
+    *copy = body[i];
+    copy->index = node->body + i;
+    body[i].declaration = copy;
+  }
+
+  for (uint32_t i = 0; i < node->body_length; i++) {
+    _ast_flatten_children(parsed, nodes + node->body + i, nodes, next);
+  }
+}
+
+uint32_t _ast_flatten_node(AstNode** parsed, AstNode* node, AstNode* nodes, uint32_t* next) {
+  uint32_t index = (*next)++;
+  AstNode* copy = nodes + index;
+  *copy = *node;
+  copy->index = index;
+  node->declaration = copy;
+
+  _ast_flatten_children(parsed, copy, nodes, next);
+  return index;
+}
+
+// Copies the tree under `root` into one allocation from `arena`, returning the
+// new root (the first of the copied nodes).  The original nodes are left
+// holding the addresses of their copies; see `ast_forwarded`.
+AstNode* flatten_ast(Arena* arena, AstNode** parsed, AstNode* root) {
+  uint32_t count = _ast_count_nodes(parsed, root);
+  AstNode* nodes = arena_alloc(arena, count * sizeof(AstNode));
+
+  uint32_t next = 0;
+  _ast_flatten_node(parsed, root, nodes, &next);
+  assert(next == count);
+
+  return nodes;
+}
+
+// The copy made of `node` by `flatten_ast`.
+// @Precondition: `node` was part of a tree which has since been flattened.
+AstNode* ast_forwarded(AstNode* node) {
+  AstNode* copy = node->declaration;
+  assert(copy != NULL && copy->id == node->id);
+  return copy;
+}
+
+// A flattened node's children, or NULL if it has none.  A node's `body` is
+// contiguous, so `node_body(node)[i]` is its `i`th body node.
+AstNode* node_lhs(AstNode* node) {
+  return node->lhs ? node - node->index + node->lhs : NULL;
+}
+
+AstNode* node_rhs(AstNode* node) {
+  return node->rhs ? node - node->index + node->rhs : NULL;
+}
+
+AstNode* node_body(AstNode* node) {
+  return node->body_length ? node - node->index + node->body : NULL;
+}
@@ -0,0 +1,106 @@
+// A bounded, lock-free, multi-producer/multi-consumer FIFO queue.
+//
+// Each cell carries a sequence number which tells producers and consumers
+// whether it's ready for them: a cell at position `p` is free for writing when
+// its sequence is `p`, and holds a value for reading when its sequence is
+// `p + 1`.  Claiming a position is a single compare-and-swap on the shared
+// enqueue (or dequeue) counter.
+
+typedef struct {
+  _Atomic size_t sequence;
+  void* value;
+} AtomicQueueCell;
+
+typedef struct {
+  size_t capacity;  // Always a power of two.
+  AtomicQueueCell* cells;
+
+  // Producers and consumers hammer on different counters; keep them on
+  // separate cache lines.
+  _Alignas(64) _Atomic size_t enqueue_position;
+  _Alignas(64) _Atomic size_t dequeue_position;
+} AtomicQueue;
+
+
+void initialize_atomic_queue(AtomicQueue* queue, size_t capacity) {
+  size_t rounded = 2;
+  while (rounded < capacity) rounded <<= 1;
+
+  queue->capacity = rounded;
+  queue->cells = malloc(rounded * sizeof(AtomicQueueCell));
+
+  for (size_t i = 0; i < rounded; i++) {
+    atomic_init(&queue->cells[i].sequence, i);
+    queue->cells[i].value = NULL;
+  }
+
+  atomic_init(&queue->enqueue_position, 0);
+  atomic_init(&queue->dequeue_position, 0);
+}
+
+AtomicQueue* new_atomic_queue(size_t capacity) {
+  assert(capacity > 0);
+
+  AtomicQueue* ret = aligned_alloc(_Alignof(AtomicQueue), sizeof(AtomicQueue));
+  initialize_atomic_queue(ret, capacity);
+  return ret;
+}
+
+// Returns zero (without blocking) if the queue is full.
+int atomic_queue_add(AtomicQueue* queue, void* value) {
+  size_t position = atomic_load_explicit(&queue->enqueue_position, memory_order_relaxed);
+
+  while (1) {
+    AtomicQueueCell* cell = &queue->cells[position & (queue->capacity - 1)];
+    size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    intptr_t difference = (intptr_t) sequence - (intptr_t) position;
+
+    if (difference == 0) {
+      if (atomic_compare_exchange_weak_explicit(&queue->enqueue_position, &position, position + 1, memory_order_relaxed, memory_order_relaxed)) {
+        cell->value = value;
+        atomic_store_explicit(&cell->sequence, position + 1, memory_order_release);
+        return 1;
+      }
+      // The failed exchange reloaded `position` for us.
+    } else if (difference < 0) {
+      return 0;
+    } else {
+      position = atomic_load_explicit(&queue->enqueue_position, memory_order_relaxed);
+    }
+  }
+}
+
+// Returns zero (without blocking) if the queue is empty.
+int atomic_queue_pull(AtomicQueue* queue, void** value) {
+  size_t position = atomic_load_explicit(&queue->dequeue_position, memory_order_relaxed);
+
+  while (1) {
+    AtomicQueueCell* cell = &queue->cells[position & (queue->capacity - 1)];
+    size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    intptr_t difference = (intptr_t) sequence - (intptr_t) (position + 1);
+
+    if (difference == 0) {
+      if (atomic_compare_exchange_weak_explicit(&queue->dequeue_position, &position, position + 1, memory_order_relaxed, memory_order_relaxed)) {
+        *value = cell->value;
+        atomic_store_explicit(&cell->sequence, position + queue->capacity, memory_order_release);
+        return 1;
+      }
+    } else if (difference < 0) {
+      return 0;
+    } else {
+      position = atomic_load_explicit(&queue->dequeue_position, memory_order_relaxed);
+    }
+  }
+}
+
+// Only a snapshot; other threads may change the queue at any time.
+size_t atomic_queue_length(AtomicQueue* queue) {
+  size_t tail = atomic_load_explicit(&queue->enqueue_position, memory_order_relaxed);
+  size_t head = atomic_load_explicit(&queue->dequeue_position, memory_order_relaxed);
+  return tail > head ? tail - head : 0;
+}
+
+void free_atomic_queue(AtomicQueue* queue) {
+  free(queue->cells);
+  free(queue);
+}
@@ -15,8 +15,8 @@ bool bytecode_handle_declaration(Pool* instructions, AstNode* node) {
 }
 
 bool bytecode_handle_assignment(Pool* instructions, AstNode* node) {
-  AstNode* decl = node->lhs;
-  AstNode* value = node->rhs;
+  AstNode* decl = node->declaration;
+  AstNode* value = node_rhs(node);
 
   bool result = bytecode_handle_node(instructions, value);
 
@@ -66,20 +66,22 @@ bool bytecode_handle_expression_literal(Pool* instructions, AstNode* node) {
 }
 
 bool bytecode_handle_expression_procedure(Pool* instructions, AstNode* node) {
-  if (node->body[0].bytecode_id == -1) return 0;
+  AstNode* block = node_body(node);
+  if (block->bytecode_id == -1) return 0;
 
-  PUSH((size_t) node->body);
+  PUSH((size_t) block);
   return 1;
 }
 
 bool bytecode_handle_expression_call(Pool* instructions, AstNode* node) {
   AstNode* decl = node->declaration;
-  AstNode* args = node->rhs;
+  AstNode* args = node_rhs(node);
+  AstNode* arg = node_body(args);
 
   bool result = 1;
 
   for (size_t i = 0; i < args->body_length; i++) {
-    result &= bytecode_handle_node(instructions, &args->body[args->body_length - i - 1]);
+    result &= bytecode_handle_node(instructions, &arg[args->body_length - i - 1]);
     if (!result) break;
   }
 
@@ -105,9 +107,10 @@ bool bytecode_handle_expression(Pool* instructions, AstNode* node) {
 
 bool bytecode_handle_compound(Pool* instructions, AstNode* node) {
   bool result = 1;
+  AstNode* body = node_body(node);
 
   for (size_t i = 0; i < node->body_length; i++) {
-    result &= bytecode_handle_node(instructions, &node->body[i]);
+    result &= bytecode_handle_node(instructions, &body[i]);
     if (!result) break;
   }
 
@@ -116,7 +119,7 @@ bool bytecode_handle_compound(Pool* instructions, AstNode* node) {
 
 bool bytecode_handle_return(Pool* instructions, AstNode* node) {
   bool result = 1;
-  AstNode* retval = node->rhs;
+  AstNode* retval = node_rhs(node);
 
   if (node->flags & NODE_CONTAINS_RHS) {
     result = bytecode_handle_node(instructions, retval);
@@ -132,8 +135,8 @@ bool bytecode_handle_return(Pool* instructions, AstNode* node) {
 
 bool bytecode_handle_conditional(Pool* instructions, AstNode* node) {
   bool result = 1;
-  AstNode* cond = node->lhs;
-  AstNode* branch = node->body;
+  AstNode* cond = node_lhs(node);
+  AstNode* branch = node_body(node);
 
   result = bytecode_handle_node(instructions, cond);
   if (!result) return result;
@@ -155,7 +158,7 @@ bool bytecode_handle_conditional(Pool* instructions, AstNode* node) {
 
 bool bytecode_handle_loop(Pool* instructions, AstNode* node) {
   bool result = 1;
-  AstNode* block = node->body;
+  AstNode* block = node_body(node);
 
   Pool bytecode;  // @Leak The contained structures are never released.
   initialize_pool(&bytecode, sizeof(size_t), 16, 64);
@@ -249,27 +252,47 @@ bool bytecode_handle_top_level_node(CompilationWorkspace* ws, AstNode* node) {
 
   if (result) {
     size_t bytecode_id = list_append(&ws->bytecode, pool_to_array(&bytecode));
+    __stats.bytecode_words += bytecode.length;
     // printf("Generated bytecode id %zu\n", bytecode_id);
     // inspect_ast_node(node); printf("\n");
     // print_bytecode(list_get(&ws->bytecode, bytecode_id));
 
     if (node->type == NODE_ASSIGNMENT) {
-      AstNode* decl = node->lhs;
+      AstNode* decl = node->declaration;
 
       list_append(&ws->initializers, node);
       list_append(&ws->global_scope.declarations, decl);
+      pipeline_wake_unresolved(ws);
     }
 
     node->bytecode_id = bytecode_id;
+    pipeline_wake(ws, node);
   }
 
   return result;
 }
 
+// Records the procedure bodies whose bytecode hasn't yet been generated, since
+// we can't generate the bytecode for `node` until they have been.
+void bytecode_find_blockers(CompilationWorkspace* ws, AstNode* node) {
+  if (node->type == NODE_EXPRESSION && (node->flags & EXPR_PROCEDURE)) {
+    AstNode* block = node_body(node);
+    if (block->bytecode_id == -1) pipeline_block_on(ws, block);
+    return;
+  }
+
+  AstNode* body = node_body(node);
+
+  if (node->flags & NODE_CONTAINS_LHS) bytecode_find_blockers(ws, node_lhs(node));
+  if (node->flags & NODE_CONTAINS_RHS) bytecode_find_blockers(ws, node_rhs(node));
+  for (size_t i = 0; i < node->body_length; i++) bytecode_find_blockers(ws, &body[i]);
+}
+
 bool perform_bytecode_job(Job* job) {
   CompilationWorkspace* ws = job->ws;
 
   bool result = bytecode_handle_top_level_node(ws, job->node);
+  if (!result) bytecode_find_blockers(ws, job->node);
 
   return result;
 }
@@ -128,14 +128,16 @@ void print_pointer(void* x) {
   printf("0x%0X", (unsigned int) x);
 }
 
-void inspect_token(Token t) {
-  printf("«Token type=%d line=%ju pos=%ju source=", t.type, t.line, t.pos);
-  print_string(&t.source);
+void inspect_token(TokenizedFile* tokens, size_t i) {
+  String source = token_source(tokens, i);
+
+  printf("«Token type=%d offset=%u source=", token_type(tokens, i), token_offset(tokens, i));
+  print_string(&source);
   printf("»\n");
 }
 
 void inspect_ast_node(AstNode* node) {
-  printf("«AstNode 0x%X type=%s flags=%x id=%zu from=%zu,%zu to=%zu,%zu ident=%d type=%x bytecode_id=%zx»", (unsigned int) node, _ast_node_type(node), node->flags, node->id, node->from.line + 1, node->from.pos + 1, node->to.line + 1, node->to.pos + 1, (int) node->ident, (unsigned int) node->typeclass, node->bytecode_id);
+  printf("«AstNode 0x%X type=%s flags=%x id=%u from=%u to=%u ident=%d type=%x bytecode_id=%x»", (unsigned int) node, _ast_node_type(node), node->flags, node->id, node->from, node->to, (int) node->ident, (unsigned int) node->typeclass, node->bytecode_id);
 }
 
 void print_tokenized_file(TokenizedFile* list){
@@ -144,11 +146,10 @@ void print_tokenized_file(TokenizedFile* list){
     return;
   }
 
-  TokenizedFile t = *list;
-  printf("List [ %ju ]\n", t.length);
+  printf("List [ %ju ]\n", list->length);
 
-  for (uintmax_t i = 0; i < t.length; i++) {
-    inspect_token(t.tokens[i]);
+  for (uintmax_t i = 0; i < list->length; i++) {
+    inspect_token(list, i);
   }
 }
 
@@ -191,17 +192,18 @@ void print_list(List* list) {
   printf("]");
 }
 
-void print_token(Token* token) {
-  printf("«Token(%d) line=%zu pos=%zu source=\"%s\" literal_type=%d is_well_formed=%d»",
-         token->type,
-         token->line,
-         token->pos,
-         to_zero_terminated_string(&token->source),
-         token->literal_type,
-         token->is_well_formed);
+void print_token(TokenizedFile* tokens, size_t i) {
+  String source = token_source(tokens, i);
+
+  printf("«Token(%d) offset=%u source=\"%s\" literal_type=%d is_well_formed=%d»",
+         token_type(tokens, i),
+         token_offset(tokens, i),
+         to_zero_terminated_string(&source),
+         token_literal_type(tokens, i),
+         token_is_well_formed(tokens, i));
 }
 
-void print_ast_node_type(AstNode* node) {
+void print_ast_node_type(String* source, AstNode* node) {
   switch (node->type) {
     case NODE_ASSIGNMENT:
       printf("ASSIGNMENT");
@@ -210,7 +212,7 @@ void print_ast_node_type(AstNode* node) {
       printf("CONDITIONAL");
       break;
     case NODE_COMPOUND:
-      printf("COMPOUND(%zu)", node->body_length);
+      printf("COMPOUND(%u)", node->body_length);
       break;
     case NODE_DECLARATION:
       printf("DECLARATION(");
@@ -226,11 +228,13 @@ void print_ast_node_type(AstNode* node) {
     case NODE_RECOVERY:
       printf("RECOVERY");
       break;
-    case NODE_TYPE:
+    case NODE_TYPE: {
+      String name = node_source(source, node);
       printf("TYPE(");
-      print_string(&node->source);
+      print_string(&name);
       printf(")");
       break;
+    }
     default:
       printf("UNKNOWN");
   }
@@ -253,102 +257,93 @@ void print_scope(Scope* scope) {
   printf("]");
 }
 
-void print_ast_node_as_tree(String* lines, AstNode* node) {
+void print_ast_node_as_tree(String* source, AstNode* node) {
   if (node == NULL) return;
 
   printf("[");
-  print_ast_node_type(node);
+  print_ast_node_type(source, node);
   printf("]");
   printf("  ");
   if (node->scope != NULL) print_scope(node->scope);
   printf("\n");
-  for (int line_number = node->from.line; line_number <= node->to.line; line_number++) {
-    String* line = &lines[line_number];
-    int mark_from = (node->from.line == line_number) ? node->from.pos : 0;
-    int mark_to = (node->to.line == line_number) ? node->to.pos : line->length;
-
-    for (int i = 0; i < mark_from; i++) {
-      printf("%c", line->data[i]);
-    }
-    if (node->flags & NODE_CONTAINS_ERROR) {
-      printf("\e[0;41m");
-    } else {
-      printf("\e[0;44m");
-    }
-    if (node->from.line == line_number) printf("«");
-    for (int i = mark_from; i < mark_to; i++) {
-      printf("%c", line->data[i]);
-    }
-    if (node->to.line == line_number) printf("»");
-    printf("\e[0m");
-    for (int i = mark_to; i < line->length; i++) {
-      printf("%c", line->data[i]);
-    }
-
-    printf("\n");
+  // Print every line the node touches, in full.
+  size_t line_start = node->from;
+  size_t line_end = node->to;
+  while (line_start > 0 && source->data[line_start - 1] != '\n') line_start--;
+  while (line_end < source->length && source->data[line_end] != '\n') line_end++;
+
+  for (size_t i = line_start; i < node->from; i++) {
+    printf("%c", source->data[i]);
+  }
+  if (node->flags & NODE_CONTAINS_ERROR) {
+    printf("\e[0;41m");
+  } else {
+    printf("\e[0;44m");
+  }
+  printf("«");
+  for (size_t i = node->from; i < node->to; i++) {
+    printf("%c", source->data[i]);
+  }
+  printf("»");
+  printf("\e[0m");
+  for (size_t i = node->to; i < line_end; i++) {
+    printf("%c", source->data[i]);
   }
+
+  printf("\n");
   printf("\n");
 
   if (node->flags & NODE_CONTAINS_LHS) {
-    print_ast_node_as_tree(lines, node->lhs);
+    print_ast_node_as_tree(source, node_lhs(node));
   }
 
   if (node->flags & NODE_CONTAINS_RHS) {
-    print_ast_node_as_tree(lines, node->rhs);
+    print_ast_node_as_tree(source, node_rhs(node));
   }
 
+  AstNode* body = node_body(node);
   for (int i = 0; i < node->body_length; i++) {
-    print_ast_node_as_tree(lines, &node->body[i]);
+    print_ast_node_as_tree(source, &body[i]);
   }
 }
 
-void print_ast_node_as_dot(String* lines, AstNode* node) {
+void print_ast_node_as_dot(String* source, AstNode* node) {
   if (node == NULL) return;
 
-  String source;
-  source.data = lines[node->from.line].data + node->from.pos;
-  source.length = 0;
-  if (node->from.line != node->to.line) {
-    source.length += lines[node->from.line].length - node->from.pos + 1;
-    for (int line_number = node->from.line + 1; line_number < node->to.line; line_number++) {
-      source.length += lines[line_number].length + 1;
-    }
-    source.length += node->to.pos;
-  } else {
-    source.length += node->to.pos - node->from.pos;
-  }
+  String text = substring(source, node->from, node->to - node->from);
 
-  printf("node_%zu [shape=record, label=<<TABLE><TR><TD ALIGN=\"center\">%s</TD></TR><TR><TD ALIGN=\"left\">", node->id, _ast_node_type(node));
-  print_dotsafe_string(&source);
+  printf("node_%u [shape=record, label=<<TABLE><TR><TD ALIGN=\"center\">%s</TD></TR><TR><TD ALIGN=\"left\">", node->id, _ast_node_type(node));
+  print_dotsafe_string(&text);
   printf("<BR ALIGN=\"LEFT\"/>");
   printf("</TD></TR></TABLE>>]\n");
 
   if (node->flags == NODE_CONTAINS_LHS) {
-    print_ast_node_as_dot(lines, node->lhs);
-    printf("node_%zu -> node_%zu [label=lhs]\n", node->id, node->lhs->id);
+    print_ast_node_as_dot(source, node_lhs(node));
+    printf("node_%u -> node_%u [label=lhs]\n", node->id, node_lhs(node)->id);
   }
 
   if (node->flags == NODE_CONTAINS_RHS) {
-    print_ast_node_as_dot(lines, node->rhs);
-    if (node->rhs != NULL) {
-      printf("node_%zu -> node_%zu [label=rhs]\n", node->id, node->rhs->id);
+    print_ast_node_as_dot(source, node_rhs(node));
+    if (node_rhs(node) != NULL) {
+      printf("node_%u -> node_%u [label=rhs]\n", node->id, node_rhs(node)->id);
     }
   }
 
   if (node->body_length > 0) {
-    printf("subgraph node_%zu_body {\n", node->id);
+    AstNode* body = node_body(node);
+    printf("subgraph node_%u_body {\n", node->id);
     printf("color=grey\n");
     for (int i = 0; i < node->body_length; i++) {
-      print_ast_node_as_dot(lines, &node->body[i]);
+      print_ast_node_as_dot(source, &body[i]);
     }
     printf("}\n");
     for (int i = 0; i < node->body_length; i++) {
-      printf("node_%zu -> node_%zu [label=body]\n", node->id, node->body[i].id);
+      printf("node_%u -> node_%u [label=body]\n", node->id, body[i].id);
     }
   }
 }
 
-void print_ast_node_as_sexpr(String* lines, AstNode* node, int indent) {
+void print_ast_node_as_sexpr(String* source, AstNode* node, int indent) {
   for (int i = 0; i < indent; i++) printf("  ");
   printf("(%s", _ast_node_type(node));
   if (node->flags & NODE_CONTAINS_IDENT) {
@@ -356,25 +351,27 @@ void print_ast_node_as_sexpr(String* lines, AstNode* node, int indent) {
     print_symbol(node->ident);
   }
   if (node->flags & NODE_CONTAINS_SOURCE) {
+    String text = node_source(source, node);
     printf(" ");
-    print_string(&node->source);
+    print_string(&text);
   }
   if (node->flags & NODE_CONTAINS_LHS) {
     printf("\n");
-    print_ast_node_as_sexpr(lines, node->lhs, indent + 1);
+    print_ast_node_as_sexpr(source, node_lhs(node), indent + 1);
   }
   if (node->flags & NODE_CONTAINS_RHS) {
     printf("\n");
-    print_ast_node_as_sexpr(lines, node->rhs, indent + 1);
+    print_ast_node_as_sexpr(source, node_rhs(node), indent + 1);
   }
   if (node->body_length) {
     printf("\n");
     for (int i = 0; i < indent; i++) printf("  ");
     printf("{");
 
+    AstNode* body = node_body(node);
     for (size_t i = 0; i < node->body_length; i++) {
       printf("\n");
-      print_ast_node_as_sexpr(lines, &node->body[i], indent + 1);
+      print_ast_node_as_sexpr(source, &body[i], indent + 1);
     }
 
     printf("\n");
@@ -384,29 +381,29 @@ void print_ast_node_as_sexpr(String* lines, AstNode* node, int indent) {
   printf(")");
 }
 
-void print_declaration_list_as_tree(String* lines, List* nodes) {
+void print_declaration_list_as_tree(String* source, List* nodes) {
   for (size_t i = 0; i < nodes->length; i++) {
     AstNode* node = list_get(nodes, i);
-    print_ast_node_as_tree(lines, node);
+    print_ast_node_as_tree(source, node);
     printf("\n");
   }
 }
 
-void print_declaration_list_as_dot(String* lines, List* nodes) {
+void print_declaration_list_as_dot(String* source, List* nodes) {
   printf("digraph G {\n");
   for (size_t i = 0; i < nodes->length; i++) {
     AstNode* node = list_get(nodes, i);
-    print_ast_node_as_dot(lines, node);
+    print_ast_node_as_dot(source, node);
     printf("\n");
   }
   printf("}\n");
 }
 
-void print_declaration_list_as_sexpr(String* lines, List* nodes) {
+void print_declaration_list_as_sexpr(String* source, List* nodes) {
   printf("(\n");
   for (size_t i = 0; i < nodes->length; i++) {
     AstNode* node = list_get(nodes, i);
-    print_ast_node_as_sexpr(lines, node, 1);
+    print_ast_node_as_sexpr(source, node, 1);
     printf("\n");
   }
   printf(")\n");
@@ -1,18 +1,67 @@
+// Regular files are mapped straight from the page cache rather than copied
+// into the heap; the mapping is read-only, and lives as long as the process.
+String* _file_map_all(int fd, size_t size) {
+  void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) return NULL;
+
+  madvise(data, size, MADV_SEQUENTIAL);
+
+  String* str = malloc(sizeof(String));
+  str->length = size;
+  str->data = data;
+  return str;
+}
+
+// Pipes and other special files don't know their size up front, so we just
+// keep reading until we run out.
+String* _file_copy_all(int fd) {
+  size_t capacity = 4096;
+  String* str = malloc(sizeof(String));
+  str->length = 0;
+  str->data = malloc(capacity);
+
+  while (1) {
+    if (str->length == capacity) {
+      capacity *= 2;
+      str->data = realloc(str->data, capacity);
+    }
+
+    ssize_t count = read(fd, str->data + str->length, capacity - str->length);
+    if (count == 0) break;
+    if (count < 0 && errno == EINTR) continue;  // Interrupted by a signal before reading anything.
+    if (count < 0) {
+      free(str->data);
+      free(str);
+      return NULL;
+    }
+
+    str->length += count;
+  }
+
+  return str;
+}
+
+// Asks the kernel to start reading the whole file into the page cache in the
+// background, so that a later `file_read_all` doesn't have to wait on the disk.
+void file_prefetch(int fd) {
+  posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+}
+
 String* file_read_all(const char* filename) {
-  FILE* f = fopen(filename, "rb");
-  if (!f) {
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
     return NULL;
   }
 
   struct stat s;
-  fstat(fileno(f), &s);
+  String* str = NULL;
 
-  String* str = malloc(sizeof(String));
-  str->length = s.st_size;
-  str->data = malloc(s.st_size * sizeof(char));
+  if (fstat(fd, &s) == 0 && S_ISREG(s.st_mode) && s.st_size > 0) {
+    str = _file_map_all(fd, s.st_size);
+  }
 
-  fread(str->data, s.st_size, 1, f);
-  fclose(f);
+  if (str == NULL) str = _file_copy_all(fd);
 
+  close(fd);
   return str;
 }
@@ -3,7 +3,7 @@ void interpreter_begin_dependency_initialization(CompilationWorkspace* ws, AstNo
 
   for (size_t i = 0; i < ws->initializers.length; i++) {
     AstNode* init = list_get(&ws->initializers, i);
-    if (init->lhs != decl) continue;
+    if (init->declaration != decl) continue;
 
     assert(init->bytecode_id != -1);
 
@@ -15,6 +15,7 @@ void interpreter_begin_dependency_initialization(CompilationWorkspace* ws, AstNo
     initializer->ip = 0;
     initializer->id = init->bytecode_id;
     initializer->waiting_on = NULL;
+    initializer->retired = 0;
     pipeline_emit_execute_job(ws, initializer);
   }
 }
@@ -24,8 +25,9 @@ void interpreter_finish_dependency_initialization(CompilationWorkspace* ws, size
     AstNode* node = list_get(&ws->initializers, i);
     if (node->bytecode_id != bytecode_id) continue;
 
-    node->lhs->flags &= ~NODE_INITIALIZING;
-    node->lhs->flags |= NODE_INITIALIZED;
+    node->declaration->flags &= ~NODE_INITIALIZING;
+    node->declaration->flags |= NODE_INITIALIZED;
+    pipeline_wake(ws, node->declaration);
     break;
   }
 }
@@ -41,6 +43,7 @@ bool perform_execute_job(Job* job) {
       state->waiting_on = NULL;
     } else {
       interpreter_begin_dependency_initialization(ws, state->waiting_on);
+      pipeline_block_on(ws, state->waiting_on);
       return 0;
     }
   }
@@ -50,6 +53,7 @@ bool perform_execute_job(Job* job) {
 
   while (1) {
     // inspect_vm_state(state, bytecode);
+    state->retired += 1;
 
     switch (bytecode[state->ip++]) {
       case BC_RETURN: {
@@ -91,6 +95,7 @@ bool perform_execute_job(Job* job) {
           state->waiting_on = decl;
 
           interpreter_begin_dependency_initialization(ws, state->waiting_on);
+          pipeline_block_on(ws, state->waiting_on);
           return 0;
         }
 
@@ -104,6 +109,7 @@ bool perform_execute_job(Job* job) {
 
         decl->pointer_value = (void*) state->stack[state->sp--];
         decl->flags |= NODE_INITIALIZED;
+        pipeline_wake(ws, decl);
         break;
       }
 
@@ -141,6 +147,7 @@ bool perform_execute_job(Job* job) {
           state->waiting_on = decl;
 
           interpreter_begin_dependency_initialization(ws, state->waiting_on);
+          pipeline_block_on(ws, state->waiting_on);
           return 0;
         }
 
@@ -1,91 +1,318 @@
-const char OPERATORS[256 - 32] = {
-  0, 1, 2, 2, 2, 1, 1, 2,  //  !"#$%&'
-  2, 2, 1, 1, 2, 1, 2, 1,  // ()*+,-./
-  0, 0, 0, 0, 0, 0, 0, 0,  // 01234567
-  0, 0, 3, 2, 1, 3, 1, 1,  // 89:;<=>?
-  3, 0, 0, 0, 0, 0, 0, 0,  // @ABCDEFG
-  0, 0, 0, 0, 0, 0, 0, 0,  // HIJKLMNO
-  0, 0, 0, 0, 0, 0, 0, 0,  // PQRSTUVW
-  0, 0, 0, 2, 2, 2, 1, 0,  // XYZ[\]^_
-  1, 0, 0, 0, 0, 0, 0, 0,  // `abcdefg
-  0, 0, 0, 0, 0, 0, 0, 0,  // hijklmno
-  0, 0, 0, 0, 0, 0, 0, 0,  // pqrstuvw
-  0, 0, 0, 2, 1, 2, 1, 0,  // xyz{|}~
+// Character classes, for every possible byte.  Control characters (other than
+// whitespace) belong to no class at all, and neither do bytes above 0x7f; those
+// are classified by the code point they encode (see `src/unicode.c`).
+typedef enum {
+  CHAR_WHITESPACE     = (1 << 0),
+  CHAR_NEWLINE        = (1 << 1),
+  CHAR_BINARY_DIGIT   = (1 << 2),
+  CHAR_DECIMAL_DIGIT  = (1 << 3),
+  CHAR_HEX_DIGIT      = (1 << 4),
+  CHAR_OPERATOR       = (1 << 5),
+  CHAR_RESERVED_OP    = (1 << 6),
+  CHAR_OPERATOR_PART  = (1 << 7),  // Anything that may continue an operator.
+  CHAR_IDENTIFIER     = (1 << 8),
+} CharacterClass;
+
+#define _OP        (CHAR_OPERATOR | CHAR_OPERATOR_PART)
+#define _RESERVED  (CHAR_RESERVED_OP | CHAR_OPERATOR_PART)
+
+const unsigned short CHARACTER_CLASSES[256] = {
+  ['\t'] = CHAR_WHITESPACE,
+  ['\n'] = CHAR_NEWLINE,
+  ['\r'] = CHAR_WHITESPACE,
+  [' ']  = CHAR_WHITESPACE,
+
+  ['!'] = _OP,        ['"'] = _RESERVED,  ['#'] = _RESERVED,  ['$'] = _RESERVED,
+  ['%'] = _OP,        ['&'] = _OP,        ['\''] = _RESERVED, ['('] = _RESERVED,
+  [')'] = _RESERVED,  ['*'] = _OP,        ['+'] = _OP,        [','] = _RESERVED,
+  ['-'] = _OP,        ['.'] = _RESERVED,  ['/'] = _OP,        [':'] = CHAR_OPERATOR_PART,
+  [';'] = _RESERVED,  ['<'] = _OP,        ['='] = CHAR_OPERATOR_PART,  ['>'] = _OP,
+  ['?'] = _OP,        ['@'] = CHAR_OPERATOR_PART,  ['['] = _RESERVED,  ['\\'] = _RESERVED,
+  [']'] = _RESERVED,  ['^'] = _OP,        ['`'] = _OP,        ['{'] = _RESERVED,
+  ['|'] = _OP,        ['}'] = _RESERVED,  ['~'] = _OP,
+
+  ['0' ... '1'] = CHAR_BINARY_DIGIT | CHAR_DECIMAL_DIGIT | CHAR_HEX_DIGIT | CHAR_IDENTIFIER,
+  ['2' ... '9'] = CHAR_DECIMAL_DIGIT | CHAR_HEX_DIGIT | CHAR_IDENTIFIER,
+  ['_']         = CHAR_BINARY_DIGIT | CHAR_DECIMAL_DIGIT | CHAR_HEX_DIGIT | CHAR_IDENTIFIER,
+  ['A' ... 'Z'] = CHAR_HEX_DIGIT | CHAR_IDENTIFIER,
+  ['a' ... 'z'] = CHAR_HEX_DIGIT | CHAR_IDENTIFIER,
 };
 
-DEFINE_STR(KEYWORD_RETURN, "return");
-DEFINE_STR(KEYWORD_IF, "if");
-DEFINE_STR(KEYWORD_LOOP, "loop");
-DEFINE_STR(KEYWORD_BREAK, "break");
+#undef _OP
+#undef _RESERVED
 
-// @Precondition: file data is never freed.
+// The kind of token that each byte begins.  `tokenize_range` looks this up once
+// per token, rather than stepping a state machine once per byte: the body of
+// each token is consumed by a tight loop (or one of the `Scanners`' vector
+// routines) over `CHARACTER_CLASSES`, which keeps whitespace, comments and
+// strings off the byte-at-a-time path altogether.
+typedef enum {
+  START_UNKNOWN,
+  START_DIRECTIVE,
+  START_TAG,
+  START_WHITESPACE,
+  START_NEWLINE,
+  START_STRING,
+  START_NUMBER,
+  START_SYNTAX_OPERATOR,
+  START_COLON,
+  START_SLASH,
+  START_OPERATOR,
+  START_UNICODE,
+  START_IDENTIFIER,
+} TokenStart;
+
+const unsigned char TOKEN_STARTS[256] = {
+  ['@'] = START_DIRECTIVE,
+  ['#'] = START_TAG,
+
+  ['\t'] = START_WHITESPACE,
+  ['\r'] = START_WHITESPACE,
+  [' ']  = START_WHITESPACE,
+  ['\n'] = START_NEWLINE,
+
+  ['"'] = START_STRING,
+  ['0' ... '9'] = START_NUMBER,
+
+  [','] = START_SYNTAX_OPERATOR,
+  ['('] = START_SYNTAX_OPERATOR,
+  [')'] = START_SYNTAX_OPERATOR,
+  ['{'] = START_SYNTAX_OPERATOR,
+  ['}'] = START_SYNTAX_OPERATOR,
+  [':'] = START_COLON,
+  ['/'] = START_SLASH,
+
+  ['!'] = START_OPERATOR,
+  ['`'] = START_OPERATOR,
+  ['$' ... '\''] = START_OPERATOR,
+  ['*' ... '+'] = START_OPERATOR,
+  ['-' ... '.'] = START_OPERATOR,
+  [';' ... '?'] = START_OPERATOR,
+  ['[' ... '^'] = START_OPERATOR,
+  ['|'] = START_OPERATOR,
+  ['~'] = START_OPERATOR,
+
+  ['A' ... 'Z'] = START_IDENTIFIER,
+  ['_'] = START_IDENTIFIER,
+  ['a' ... 'z'] = START_IDENTIFIER,
+  [0x80 ... 0xff] = START_UNICODE,
+};
+
+// The seeded symbols for tokens which are always a single byte, so the lexer
+// needn't intern them.
+const Symbol SYNTAX_SYMBOLS[256] = {
+  ['\n'] = OP_NEWLINE,
+  [','] = OP_COMMA,
+  ['('] = OP_OPEN_PAREN,
+  [')'] = OP_CLOSE_PAREN,
+  ['{'] = OP_OPEN_BRACE,
+  ['}'] = OP_CLOSE_BRACE,
+};
+
+// ** Integer Literals ** //
+
+// Integer literals are evaluated once, as they're lexed.  Wherever the next
+// eight digits contain no `_` separators, they're converted together with SWAR
+// arithmetic on a single 64-bit word; the first digit lands in the lowest byte,
+// so this only applies on little-endian targets.  Each returns zero if the
+// value doesn't fit in 64 bits.
+//
+// @Precondition: every byte is a valid digit for the base, or a separator.
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define LITERAL_SWAR 1
+#else
+#define LITERAL_SWAR 0
+#endif
+
+#define ONES  0x0101010101010101ULL
+
+// Loads the next eight digits into CHUNK, if there are eight without a separator.
+#define NEXT_EIGHT_DIGITS(CHUNK)                                               \
+  (LITERAL_SWAR && i + 8 <= length &&                                          \
+   (memcpy(&CHUNK, data + i, 8),                                               \
+    !((((CHUNK) ^ (ONES * '_')) - ONES) & ~((CHUNK) ^ (ONES * '_')) & (ONES * 0x80))))
+
+bool parse_decimal_literal(const char* data, size_t length, uint64_t* result) {
+  uint64_t value = 0;
+  bool fits = 1;
+
+  for (size_t i = 0; i < length;) {
+    uint64_t chunk;
+    if (NEXT_EIGHT_DIGITS(chunk)) {
+      chunk -= ONES * '0';
+      chunk = (chunk * 10 + (chunk >> 8)) & 0x00FF00FF00FF00FF;
+      chunk = (chunk * 100 + (chunk >> 16)) & 0x0000FFFF0000FFFF;
+      chunk = (chunk * 10000 + (chunk >> 32)) & 0x00000000FFFFFFFF;
+
+      fits &= !__builtin_mul_overflow(value, 100000000, &value);
+      fits &= !__builtin_add_overflow(value, chunk, &value);
+      i += 8;
+    } else {
+      char c = data[i++];
+      if (c == '_') continue;
+
+      fits &= !__builtin_mul_overflow(value, 10, &value);
+      fits &= !__builtin_add_overflow(value, c - '0', &value);
+    }
+  }
+
+  *result = value;
+  return fits;
+}
+
+bool parse_hex_literal(const char* data, size_t length, uint64_t* result) {
+  uint64_t value = 0;
+  bool fits = 1;
+
+  for (size_t i = 0; i < length;) {
+    uint64_t chunk;
+    if (NEXT_EIGHT_DIGITS(chunk)) {
+      // Letters (of either case) have bit 6 set, and a low nibble nine less
+      // than their value.
+      chunk = (chunk & (ONES * 0x0F)) + ((chunk >> 6) & ONES) * 9;
+      chunk = ((chunk & 0x00FF00FF00FF00FF) << 4) | ((chunk >> 8) & 0x00FF00FF00FF00FF);
+      chunk = ((chunk & 0x0000FFFF0000FFFF) << 8) | ((chunk >> 16) & 0x0000FFFF0000FFFF);
+      chunk = ((chunk & 0x00000000FFFFFFFF) << 16) | (chunk >> 32);
+
+      fits &= (value >> 32) == 0;
+      value = (value << 32) | chunk;
+      i += 8;
+    } else {
+      char c = data[i++];
+      if (c == '_') continue;
+
+      fits &= (value >> 60) == 0;
+      value = (value << 4) | ((c & 0x0F) + (c >> 6) * 9);
+    }
+  }
+
+  *result = value;
+  return fits;
+}
+
+bool parse_binary_literal(const char* data, size_t length, uint64_t* result) {
+  uint64_t value = 0;
+  bool fits = 1;
+
+  for (size_t i = 0; i < length;) {
+    uint64_t chunk;
+    if (NEXT_EIGHT_DIGITS(chunk)) {
+      // Gathers the low bit of each byte into the top byte, first digit highest.
+      chunk = ((chunk & ONES) * 0x8040201008040201) >> 56;
+
+      fits &= (value >> 56) == 0;
+      value = (value << 8) | chunk;
+      i += 8;
+    } else {
+      char c = data[i++];
+      if (c == '_') continue;
+
+      fits &= (value >> 63) == 0;
+      value = (value << 1) | (c - '0');
+    }
+  }
+
+  *result = value;
+  return fits;
+}
+
+#undef NEXT_EIGHT_DIGITS
+#undef ONES
+#undef LITERAL_SWAR
+
+
+// ** Identifiers ** //
+
+// Returns the position of the first byte at or after `pos` which doesn't
+// continue an identifier.  ASCII runs are handled by the vectorized scanner;
+// anything else is decoded, and checked against the Unicode ranges.
+size_t _lex_identifier(const Scanners* scan, const char* data, size_t pos, size_t length) {
+  while (1) {
+    pos = scan->identifier(data, pos, length);
+    if (pos == length || (unsigned char) data[pos] < 0x80) return pos;
+
+    size_t size = unicode_identifier_length(data, pos, length, 0);
+    if (size == 0) return pos;
+    pos += size;
+  }
+}
+
+
+// Appends the tokens in `input`, from `start` up to `end`, to `result`.
 // @Precondition: input data is never freed.
-void tokenize_string(FileInfo* file, TokenizedFile* result) {
-  String* input = file->source;
+// @Precondition: `start` and `end` each fall at the start of a line, or at the
+//                very start or end of the input.
+// @Precondition: `end` is addressable by a FileAddress; the parser rejects
+//                larger files before pulling any tokens from past that point.
+void tokenize_range(String* input, size_t start, size_t end, TokenizedFile* result) {
+  assert(end <= UINT32_MAX);
 
-  size_t input_length = input->length;
-  Pool* tokens = new_pool(sizeof(Token), 128, 32);
-  Pool* lines = new_pool(sizeof(String), 128, 32);
+  const Scanners* scan = select_scanners();
+  size_t tokens_before = result->length;
 
-  size_t token_start = 0; // Position in the file where the current token began.
-  size_t file_pos = 0;    // Position in the file we're currently parsing.
+  // This is a separate pass, but for ASCII input it's just a vector compare.
+  size_t invalid = utf8_validate(scan, input->data, start, end);
+  if (invalid < end && invalid < result->invalid_utf8) result->invalid_utf8 = invalid;
 
-  size_t line_no = 0;     // Line number we're parsing.
-  size_t line_pos = 0;    // Position within the line we're parsing.
-  size_t line_start = 0;  // File offset for beginning of the current line.
+  size_t input_length = end;
+  size_t token_start = start; // Position in the file where the current token began.
+  size_t file_pos = start;    // Position in the file we're currently parsing.
 
   #define THIS  (input->data[file_pos])
   #define LAST  (input->data[file_pos - 1])
-  #define NEXT  (file_pos + 1 < input->length ? input->data[file_pos + 1] : '\0')
+  #define PEEK  (file_pos < input_length ? input->data[file_pos] : '\0')
+  #define NEXT  (file_pos + 1 < input_length ? input->data[file_pos + 1] : '\0')
   #define LENGTH  (file_pos - token_start)
-  #define SOURCE  (substring(input, token_start, LENGTH))
-
-  #define IS_WHITESPACE(T)    (T == ' ' || T == '\t')
-  #define IS_NEWLINE(T)       (T == '\n')
-  #define IS_BINARY_DIGIT(T)  (T == '_' || T == '0' || T == '1')
-  #define IS_DECIMAL_DIGIT(T) (T == '_' || (T >= '0' && T <= '9'))
-  #define IS_HEX_DIGIT(T)     (IS_DECIMAL_DIGIT(T) || (T >= 'a' && T <= 'z') || (T >= 'A' && T <= 'Z'))
-  #define IS_OPERATOR(T)      (OPERATORS[T - 32] == 1)
-  #define IS_RESERVED_OP(T)   (OPERATORS[T - 32] == 2)
-  #define IS_NONINITIAL_OP(T) (OPERATORS[T - 32])
-  #define IS_IDENTIFIER(T)    (!(IS_WHITESPACE(T) || IS_NEWLINE(T) || IS_NONINITIAL_OP(T)))
-
-  #define ADVANCE(EXPECTED)   do { assert(EXPECTED == THIS); file_pos += 1; line_pos += 1; } while (0)
-
-  #define SLURP(COND)             while (file_pos < input_length && COND) { ADVANCE(THIS); }
-  #define SLURP_WHITESPACE()      SLURP(IS_WHITESPACE(THIS))
+  #define SYMBOL  (symbol_get(&(String) { LENGTH, input->data + token_start }))
+
+  #define CLASS(T)            (CHARACTER_CLASSES[(unsigned char) (T)])
+  #define IS_WHITESPACE(T)    (CLASS(T) & CHAR_WHITESPACE)
+  #define IS_NEWLINE(T)       (CLASS(T) & CHAR_NEWLINE)
+  #define IS_BINARY_DIGIT(T)  (CLASS(T) & CHAR_BINARY_DIGIT)
+  #define IS_DECIMAL_DIGIT(T) (CLASS(T) & CHAR_DECIMAL_DIGIT)
+  #define IS_HEX_DIGIT(T)     (CLASS(T) & CHAR_HEX_DIGIT)
+  #define IS_OPERATOR(T)      (CLASS(T) & CHAR_OPERATOR)
+  #define IS_RESERVED_OP(T)   (CLASS(T) & CHAR_RESERVED_OP)
+  #define IS_NONINITIAL_OP(T) (CLASS(T) & CHAR_OPERATOR_PART)
+
+  #define ADVANCE(EXPECTED)   do { assert(EXPECTED == THIS); file_pos += 1; } while (0)
+
+  #define SLURP(COND)             while (file_pos < input_length && COND) file_pos += 1;
+  #define SCAN(SCANNER)           (file_pos = scan->SCANNER(input->data, file_pos, input_length))
+  #define SLURP_WHITESPACE()      SCAN(whitespace)
   #define SLURP_NEWLINES()        SLURP(IS_NEWLINE(THIS))
-  #define SLURP_TO_EOL()          SLURP(!IS_NEWLINE(THIS))
+  #define SLURP_TO_EOL()          SCAN(line)
+  #define SLURP_STRING()          SCAN(string)
   #define SLURP_COMMENT()         SLURP(IS_NEWLINE(THIS))
   #define SLURP_BINARY_NUMBER()   SLURP(IS_BINARY_DIGIT(THIS))
   #define SLURP_DECIMAL_NUMBER()  SLURP(IS_DECIMAL_DIGIT(THIS))
   #define SLURP_HEX_NUMBER()      SLURP(IS_HEX_DIGIT(THIS))
   #define SLURP_OPERATOR()        SLURP(IS_NONINITIAL_OP(THIS))
-  #define SLURP_IDENT()           SLURP(IS_IDENTIFIER(THIS))
+  #define SLURP_IDENT()           (file_pos = _lex_identifier(scan, input->data, file_pos, input_length))
 
   #define START()    (token_start = file_pos)
 
   while (file_pos < input_length) {
     token_start = file_pos;
 
-    switch (THIS) {
-      case '@':
+    switch (TOKEN_STARTS[(unsigned char) THIS]) {
+      case START_DIRECTIVE:
         ADVANCE('@');
         SLURP_IDENT();
-        *((Token*) pool_get(tokens)) = (Token) { TOKEN_DIRECTIVE, line_no, line_pos - LENGTH, SOURCE, NONLITERAL, 1 };
+        tokenized_file_append(result, TOKEN_DIRECTIVE, token_start, LENGTH, NONLITERAL, 1, SYMBOL);
         break;
-      case '#':
+      case START_TAG:
         ADVANCE('#');
         SLURP_IDENT();
-        *((Token*) pool_get(tokens)) = (Token) { TOKEN_TAG, line_no, line_pos - LENGTH, SOURCE, NONLITERAL, 1 };
+        tokenized_file_append(result, TOKEN_TAG, token_start, LENGTH, NONLITERAL, 1, SYMBOL);
         break;
-      case ' ':
-      case '\t':
+      case START_WHITESPACE:
         SLURP_WHITESPACE();
         // @TODO Figure out how to differentiate `ident (` from `ident(`.  Do
         //       we really even care?
         break;
-      case '\n':
+      case START_NEWLINE:
         {
           // while (file_pos < input_length && IS_NEWLINE(THIS)) {
           //   *((String*) pool_get(lines)) = (String) { file_pos - line_start, input->data + line_start };
@@ -95,38 +322,34 @@ void tokenize_string(FileInfo* file, TokenizedFile* result) {
           //   SLURP_WHITESPACE();
           // }
 
-          ADVANCE(THIS);
-          *((String*) pool_get(lines)) = (String) { file_pos - line_start - 1, input->data + line_start };
-          *((Token*) pool_get(tokens)) = (Token) { TOKEN_SYNTAX_OPERATOR, line_no, line_pos - LENGTH, SOURCE, NONLITERAL, 1 };
-          line_no += 1;
-          line_start = file_pos;
-          line_pos = 0;
+          ADVANCE('\n');
+          tokenized_file_append(result, TOKEN_SYNTAX_OPERATOR, token_start, LENGTH, NONLITERAL, 1, OP_NEWLINE);
           SLURP_WHITESPACE();
           break;
         }
-      case '"':
+      case START_STRING:
         do {
           ADVANCE('"');
-          SLURP(THIS != '"' && !IS_NEWLINE(THIS));
-        } while (LAST == '\\' && !IS_NEWLINE(THIS));
+          SLURP_STRING();
+        } while (LAST == '\\' && file_pos < input_length && !IS_NEWLINE(THIS));
 
         if (file_pos < input_length && !IS_NEWLINE(THIS)) {
           ADVANCE('"');
         }
 
-        *((Token*) pool_get(tokens)) = (Token) { TOKEN_LITERAL, line_no, line_pos - LENGTH, SOURCE, IS_STRING_LITERAL, input->data[token_start] == input->data[file_pos - 1] };
+        tokenized_file_append(result, TOKEN_LITERAL, token_start, LENGTH, IS_STRING_LITERAL, input->data[token_start] == input->data[file_pos - 1], SYMBOL_NONE);
         break;
-      case '0'...'9':
+      case START_NUMBER:
         {
           TokenLiteralType literal_type = NONLITERAL;
 
           if (THIS == '0') {
             ADVANCE('0');
-            if (THIS == 'x') {
+            if (PEEK == 'x') {
               literal_type = IS_HEX_LITERAL;
               ADVANCE('x');
               SLURP_HEX_NUMBER();
-            } else if (THIS == 'b') {
+            } else if (PEEK == 'b') {
               literal_type = IS_BINARY_LITERAL;
               ADVANCE('b');
               SLURP_BINARY_NUMBER();
@@ -137,7 +360,7 @@ void tokenize_string(FileInfo* file, TokenizedFile* result) {
             literal_type = IS_DECIMAL_LITERAL;
             SLURP_DECIMAL_NUMBER();
 
-            if (THIS == '.') {
+            if (PEEK == '.') {
               literal_type = IS_FRACTIONAL_LITERAL;
               ADVANCE('.');
               SLURP_DECIMAL_NUMBER();
@@ -145,85 +368,93 @@ void tokenize_string(FileInfo* file, TokenizedFile* result) {
           }
 
           // @TODO Parse numeric literals more loosely, reporting malformed literals.
-          *((Token*) pool_get(tokens)) = (Token) { TOKEN_LITERAL, line_no, line_pos - LENGTH, SOURCE, literal_type, 1 };
+          const char* digits = input->data + token_start;
+          uint64_t value;
+          bool fits;
+
+          if (literal_type == IS_FRACTIONAL_LITERAL) {
+            tokenized_file_append(result, TOKEN_LITERAL, token_start, LENGTH, literal_type, 1, SYMBOL_NONE);
+          } else {
+            if (literal_type == IS_HEX_LITERAL) {
+              fits = parse_hex_literal(digits + 2, LENGTH - 2, &value);
+            } else if (literal_type == IS_BINARY_LITERAL) {
+              fits = parse_binary_literal(digits + 2, LENGTH - 2, &value);
+            } else {
+              fits = parse_decimal_literal(digits, LENGTH, &value);
+            }
+
+            tokenized_file_append_integer(result, token_start, LENGTH, literal_type, value, fits);
+          }
         }
         break;
-      case ',':
-      case '(':
-      case ')':
-      case '{':
-      case '}':
+      case START_SYNTAX_OPERATOR:
         ADVANCE(THIS);
-        *((Token*) pool_get(tokens)) = (Token) { TOKEN_SYNTAX_OPERATOR, line_no, line_pos - LENGTH, SOURCE, NONLITERAL, 1 };
+        tokenized_file_append(result, TOKEN_SYNTAX_OPERATOR, token_start, LENGTH, NONLITERAL, 1, SYNTAX_SYMBOLS[(unsigned char) LAST]);
         break;
-      case ':':
+      case START_COLON:
         SLURP_OPERATOR();
-        *((Token*) pool_get(tokens)) = (Token) { TOKEN_SYNTAX_OPERATOR, line_no, line_pos - LENGTH, SOURCE, NONLITERAL, 1 };
+        tokenized_file_append(result, TOKEN_SYNTAX_OPERATOR, token_start, LENGTH, NONLITERAL, 1, SYMBOL);
         break;
-      case '/':
+      case START_SLASH:
         if (NEXT == '/') {
           SLURP_TO_EOL();
           break;
         } else {
           // Continue to process as an operator.
         }
-      case '!':
-      case '`':
-      case '$'...'\'':
-      case '*'...'+':
-      case '-'...'.':
-      case ';'...'?':
-      case '['...'^':
-      case '|':
-      case '~':
+      case START_OPERATOR:
         SLURP_OPERATOR();
-        *((Token*) pool_get(tokens)) = (Token) { TOKEN_OPERATOR, line_no, line_pos - LENGTH, SOURCE, NONLITERAL, 1 };
+        tokenized_file_append(result, TOKEN_OPERATOR, token_start, LENGTH, NONLITERAL, 1, SYMBOL);
         break;
-      default:
-        SLURP_IDENT();
-        TokenType type = TOKEN_IDENTIFIER;
-        String source = SOURCE;
-
-        bool is_keyword = string_equals(&source, KEYWORD_RETURN) ||
-                          string_equals(&source, KEYWORD_IF) ||
-                          string_equals(&source, KEYWORD_LOOP) ||
-                          string_equals(&source, KEYWORD_BREAK);
-
-        if (is_keyword) {
-          type = TOKEN_KEYWORD;
+      case START_UNKNOWN:
+        ADVANCE(THIS);
+        tokenized_file_append(result, TOKEN_UNKNOWN, token_start, LENGTH, NONLITERAL, 0, SYMBOL_NONE);
+        break;
+      case START_UNICODE:
+        if (!unicode_identifier_length(input->data, file_pos, input_length, 1)) {
+          // Either not valid UTF-8 (which the parser will report), or a
+          // character which can't begin an identifier.
+          uint32_t codepoint;
+          size_t size = utf8_decode(input->data, file_pos, input_length, &codepoint);
+          file_pos += size ? size : 1;
+          tokenized_file_append(result, TOKEN_UNKNOWN, token_start, LENGTH, NONLITERAL, 0, SYMBOL_NONE);
+          break;
+        } else {
+          // Continue to process as an identifier.
         }
+      case START_IDENTIFIER:
+        SLURP_IDENT();
+        Symbol symbol = SYMBOL;
+        TokenType type = IS_KEYWORD_SYMBOL(symbol) ? TOKEN_KEYWORD : TOKEN_IDENTIFIER;
 
-        *((Token*) pool_get(tokens)) = (Token) { type, line_no, line_pos - LENGTH, source, NONLITERAL, 1 };
+        tokenized_file_append(result, type, token_start, LENGTH, NONLITERAL, 1, symbol);
     }
   }
 
-  // @TODO Do we need to make sure the token stream ends with a newline?
-  result->length = tokens->length;
-  result->tokens = pool_to_array(tokens);
-
-  file->length = lines->length;
-  file->lines = pool_to_array(lines);
-
-  free(tokens);
-  free(lines);
+  __stats.tokens += result->length - tokens_before;
 
   #undef THIS
+  #undef PEEK
   #undef LAST
   #undef NEXT
   #undef LENGTH
-  #undef SOURCE
+  #undef SYMBOL
+  #undef CLASS
   #undef IS_WHITESPACE
   #undef IS_NEWLINE
   #undef IS_BINARY_DIGIT
   #undef IS_DECIMAL_DIGIT
   #undef IS_HEX_DIGIT
   #undef IS_OPERATOR
-  #undef IS_IDENTIFIER
+  #undef IS_RESERVED_OP
+  #undef IS_NONINITIAL_OP
   #undef ADVANCE
   #undef SLURP
+  #undef SCAN
   #undef SLURP_WHITESPACE
   #undef SLURP_NEWLINES
   #undef SLURP_TO_EOL
+  #undef SLURP_STRING
   #undef SLURP_COMMENT
   #undef SLURP_BINARY_NUMBER
   #undef SLURP_DECIMAL_NUMBER
@@ -234,10 +465,172 @@ void tokenize_string(FileInfo* file, TokenizedFile* result) {
 }
 
 
+// @Precondition: file data is never freed.
+void tokenize_string(FileInfo* file, TokenizedFile* result) {
+  initialize_tokenized_file(result, file->source);
+  tokenize_range(file->source, 0, file->source->length, result);
+
+  // @TODO Do we need to make sure the token stream ends with a newline?
+}
+
+
+// ** Streaming ** //
+
+// Files larger than this are lexed as a stream of chunks of about this size,
+// which the parser pulls in as it runs out of tokens, discarding those it has
+// finished with; so only a few chunks' worth of tokens are ever held at once.
+// With a scheduler, the next few chunks are lexed in the background while the
+// parser works through the current one.
+//
+// Every newline is a token of its own (string literals and comments both stop
+// at one), so splitting just after a newline yields exactly the tokens a single
+// pass would; and since tokens record byte offsets, no positions need
+// adjusting afterwards.
+#define LEX_CHUNK_SIZE    (1 << 20)
+#define LEX_CHUNKS_AHEAD  4
+
+typedef struct {
+  FileInfo* file;
+  size_t start;
+  size_t end;
+  TokenizedFile tokens;
+  size_t pending;
+} LexChunk;
+
+typedef struct TokenStream {
+  FileInfo* file;
+  Scheduler* scheduler;  // NULL to lex each chunk only once it's pulled.
+
+  size_t next;  // Offset of the first byte not yet assigned to a chunk.
+
+  // A ring of the chunks under way, oldest first.
+  LexChunk chunks[LEX_CHUNKS_AHEAD];
+  size_t first;
+  size_t count;
+} TokenStream;
+
+// Runs on a scheduler thread.
+void perform_lex_chunk_task(void* data) {
+  LexChunk* chunk = data;
+  double started = trace_now();
+
+  initialize_tokenized_file(&chunk->tokens, chunk->file->source);
+  tokenize_range(chunk->file->source, chunk->start, chunk->end, &chunk->tokens);
+
+  trace_record((TraceEvent) { "lex chunk", chunk->file }, started);
+}
+
+void _token_stream_start_chunks(TokenStream* stream) {
+  const Scanners* scan = select_scanners();
+  String* input = stream->file->source;
+
+  while (stream->count < LEX_CHUNKS_AHEAD && stream->next < input->length) {
+    size_t start = stream->next;
+    size_t end = start + LEX_CHUNK_SIZE;
+    if (end >= input->length) {
+      end = input->length;
+    } else {
+      end = scan->line(input->data, end, input->length);
+      if (end < input->length) end += 1;
+    }
+    stream->next = end;
+
+    LexChunk* chunk = &stream->chunks[(stream->first + stream->count) % LEX_CHUNKS_AHEAD];
+    *chunk = (LexChunk) { stream->file, start, end };
+    stream->count += 1;
+
+    if (stream->scheduler != NULL) {
+      chunk->pending = 1;
+      scheduler_submit(stream->scheduler, perform_lex_chunk_task, chunk, &chunk->pending);
+    }
+  }
+}
+
+// @Precondition: file data is never freed.
+TokenStream* new_token_stream(Scheduler* scheduler, FileInfo* file) {
+  TokenStream* stream = calloc(1, sizeof(TokenStream));
+  stream->file = file;
+  stream->scheduler = scheduler;
+
+  _token_stream_start_chunks(stream);
+  return stream;
+}
+
+// Appends the next chunk's tokens to `tokens`, returning false once the whole
+// file has been lexed.
+bool token_stream_next(TokenStream* stream, TokenizedFile* tokens) {
+  if (stream->count == 0) return 0;
+
+  LexChunk* chunk = &stream->chunks[stream->first];
+  if (stream->scheduler != NULL) {
+    scheduler_wait(stream->scheduler, &chunk->pending);
+  } else {
+    perform_lex_chunk_task(chunk);
+  }
+
+  tokenized_file_extend(tokens, &chunk->tokens);
+  free_tokenized_file(&chunk->tokens);
+
+  stream->first = (stream->first + 1) % LEX_CHUNKS_AHEAD;
+  stream->count -= 1;
+
+  _token_stream_start_chunks(stream);
+  return 1;
+}
+
+void free_token_stream(TokenStream* stream) {
+  // Background chunks can't be abandoned while a worker may be writing to them.
+  for (size_t i = 0; i < stream->count && stream->scheduler != NULL; i++) {
+    LexChunk* chunk = &stream->chunks[(stream->first + i) % LEX_CHUNKS_AHEAD];
+    scheduler_wait(stream->scheduler, &chunk->pending);
+    free_tokenized_file(&chunk->tokens);
+  }
+
+  free(stream);
+}
+
+// Prepares `result` to have the file's tokens pulled into it a chunk at a time.
+void tokenize_string_streaming(Scheduler* scheduler, FileInfo* file, TokenizedFile* result) {
+  initialize_tokenized_file(result, file->source);
+  result->stream = new_token_stream(scheduler, file);
+}
+
+// Pulls the next chunk of tokens into `tokens`, returning false if the whole
+// file is already held.
+bool tokenized_file_pull(TokenizedFile* tokens) {
+  if (tokens->stream == NULL) return 0;
+  if (token_stream_next(tokens->stream, tokens)) return 1;
+
+  free_token_stream(tokens->stream);
+  tokens->stream = NULL;
+  return 0;
+}
+
+
+// Runs on a scheduler thread; must not touch any shared workspace state.
+void perform_prefetch_task(void* data) {
+  FileInfo* file = data;
+  double started = trace_now();
+
+  read_file(file);
+
+  // Large files are left for the lex job, which streams them.
+  if (file->source != NULL && file->source->length <= LEX_CHUNK_SIZE) {
+    file->tokens = malloc(sizeof(TokenizedFile));
+    tokenize_string(file, file->tokens);
+  }
+
+  trace_record((TraceEvent) { "prefetch", file }, started);
+}
+
 bool perform_lex_job(Job* job) {
-  TokenizedFile* result = malloc(sizeof(TokenizedFile));
+  TokenizedFile* result = job->file->tokens;
+
+  if (result == NULL) {
+    result = malloc(sizeof(TokenizedFile));
+    tokenize_string_streaming(job->ws->scheduler, job->file, result);
+  }
 
-  tokenize_string(job->file, result);
   pipeline_emit_parse_job(job->ws, job->file, result);
   return 1;
 }
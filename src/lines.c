@@ -0,0 +1,49 @@
+// A file's line table is only needed to report diagnostics (and by the debug
+// printers), so rather than having the lexer build one for every file, we
+// build it the first time a position in the file needs to be located.
+//
+// @Precondition: only called from the main thread.
+
+String* file_lines(FileInfo* file) {
+  if (file->lines != NULL) return file->lines;
+
+  const Scanners* scan = select_scanners();
+  String* source = file->source;
+  Pool* lines = new_pool(sizeof(String), 128, 32);
+
+  // Every file has at least one (possibly empty) line, and a trailing newline
+  // begins one more, so that every offset up to and including the end of the
+  // file can be located.
+  size_t start = 0;
+  while (1) {
+    size_t end = scan->line(source->data, start, source->length);
+    *((String*) pool_get(lines)) = (String) { end - start, source->data + start };
+
+    if (end == source->length) break;
+    start = end + 1;
+  }
+
+  file->length = lines->length;
+  file->lines = pool_to_array(lines);
+  free(lines);
+
+  return file->lines;
+}
+
+FileLocation file_locate(FileInfo* file, FileAddress address) {
+  String* lines = file_lines(file);
+  char* target = file->source->data + address;
+
+  size_t lo = 0;
+  size_t hi = file->length;
+  while (hi - lo > 1) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (lines[mid].data <= target) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return (FileLocation) { lo, target - lines[lo].data };
+}
@@ -65,6 +65,16 @@ size_t list_append(List* list, void* value) {
   return list->length - 1;
 }
 
+// @Precondition: `idx` is less than the list's length.
+void list_set(List* list, size_t idx, void* value) {
+  assert(idx < list->length);
+
+  size_t bucket = idx / list->bucket_size;
+  size_t bucket_idx = idx % list->bucket_size;
+
+  list->buckets[bucket][bucket_idx] = value;
+}
+
 void free_list(List* list) {
   if (list->bucket_size > 0) {
     size_t bucket_count = list->capacity / list->bucket_size;
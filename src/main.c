@@ -6,11 +6,21 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/syscall.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "src/string.c"
@@ -18,9 +28,12 @@
 #include "src/table.c"
 #include "src/list.c"
 #include "src/pool.c"
+#include "src/arena.c"
 #include "src/queue.c"
+#include "src/atomic_queue.c"
 #include "src/stack.c"
 #include "src/symbol.c"
+#include "src/scheduler.c"
 
 // ** Constant Strings ** //
 
@@ -63,34 +76,60 @@ typedef enum {
   IS_STRING_LITERAL      = (1 << 12),
 } TokenLiteralType;
 
+// The narrowest unsigned width which holds an integer literal's value; these
+// travel alongside the TokenLiteralType bits, into the AstNode's flags.
+typedef enum {
+  LITERAL_8_BITS         = (0 << 13),
+  LITERAL_16_BITS        = (1 << 13),
+  LITERAL_32_BITS        = (2 << 13),
+  LITERAL_64_BITS        = (3 << 13),
+} LiteralWidth;
+
+#define LITERAL_WIDTH_MASK     (3 << 13)
+#define LITERAL_WIDTH_BITS(F)  (8 << (((F) & LITERAL_WIDTH_MASK) >> 13))
+
+// Tokens are stored column-wise; see `src/tokens.c` for the accessors.
 typedef struct {
-  TokenType type;
-  size_t line;
-  size_t pos;
+  size_t base;            // Number of the first token held; earlier ones have been discarded.
+  size_t length;
+  size_t capacity;
 
-  String source;
+  unsigned char* types;   // TokenType.
+  unsigned char* flags;   // TokenLiteralType and LiteralWidth, and whether it's well formed.
+  uint32_t* offsets;      // Byte offset of the token within `source`.
+  uint32_t* lengths;
+  uint32_t* symbols;      // Interned source text.
 
-  TokenLiteralType literal_type;
-  bool is_well_formed;
-} Token;
+  uint64_t* values;       // Integer literal values, computed by the lexer.
+  uint32_t* value_tokens; // Number of the token each value belongs to, ascending.
+  size_t value_count;
+  size_t value_capacity;
+
+  String* source;
+  size_t invalid_utf8;    // Offset of the first byte which isn't valid UTF-8; the source length if none.
+
+  struct TokenStream* stream;  // Lexes further tokens on demand; NULL once the whole file is held.
+} TokenizedFile;
 
 
+// Positions are stored as byte offsets into the file's source, and only
+// converted to a line and column when a diagnostic needs one.
+typedef uint32_t FileAddress;
+
 typedef struct {
   size_t line;
   size_t pos;
-} FileAddress;
+} FileLocation;
 
 typedef struct {
   String* filename;
   String* source;
-  String* lines;
+  String* lines;  // Built on demand by `file_lines`; NULL until then.
   size_t length; // @TODO Rename `line_count`, or box `lines` in an "Array"
-} FileInfo;
 
-typedef struct {
-  Token* tokens;
-  size_t length;
-} TokenizedFile;
+  TokenizedFile* tokens;  // Populated early if the file was lexed in the background.
+  size_t pending;         // Outstanding background tasks for this file.
+} FileInfo;
 
 
 typedef struct Scope {
@@ -100,12 +139,28 @@ typedef struct Scope {
 
 typedef struct {
   Queue pipeline;
+  Scheduler* scheduler;  // NULL when running single-threaded.
+
+  Pool jobs;
+  struct Job* free_jobs;
+
+  List blockers;              // Nodes the running job is waiting on.
+  struct Job* parked;         // Jobs waiting for a blocker to be resolved.
+  struct Waiter* unresolved;  // Jobs waiting for new global declarations.
+
+  Table loaded_files;    // FileInfo by canonical path, and by device and inode.
+  Table loaded_sources;  // FileInfo by source text.
+
   Symbol entry;
   size_t entry_id;
   List bytecode;
   List initializers;
   Scope global_scope;
   Table typeclasses;
+
+  Arena arena;  // AST, scope and type data; released all at once after compilation.
+  IdTable node_errors;  // String* by node id.
+  IdTable waitlists;    // Waiter* by node id.
 } CompilationWorkspace;
 
 // Update docs/parser/node-usage.md when this changes.
@@ -161,22 +216,28 @@ typedef struct {
 } Typeclass;
 
 // Update docs/parser/node-usage.md when this changes.
+//
+// Nodes are kept small, since the later passes walk every one of them: the
+// node's source text is recovered from its span, and the few nodes with an
+// error or with jobs waiting on them have those kept in side tables in the
+// CompilationWorkspace, keyed by the node's `id`.  Children are indices into
+// the array holding the node's top-level statement; see `flatten_ast`.
 typedef struct AstNode {
   AstNodeType type;
   AstNodeFlags flags;         // 0
-  size_t id;                  // Serial number
-  size_t bytecode_id;         // Serial number
+  uint32_t id;                // Serial number
+  uint32_t bytecode_id;       // Serial number
 
   FileAddress from;           // ---
   FileAddress to;             // ---
 
   Symbol ident;               // ---
-  String source;              // ---
-  struct AstNode* lhs;        // ---
-  struct AstNode* rhs;        // ---
+  uint32_t body_length;       // ---
 
-  size_t body_length;         // ---
-  struct AstNode* body;       // ---
+  uint32_t lhs;               // ---
+  uint32_t rhs;               // ---
+  uint32_t body;              // ---
+  uint32_t index;             // ---
 
   Scope* scope;               // ---
 
@@ -187,8 +248,6 @@ typedef struct AstNode {
     void* pointer_value;
     struct AstNode* declaration;
   };
-
-  String* error;              // NULL
 } AstNode;
 
 
@@ -231,16 +290,24 @@ typedef struct {
   size_t stack[512];
 
   AstNode* waiting_on;
+  size_t retired;  // Instructions executed so far.
 } VmState;
 
+#include "src/tokens.c"
+#include "src/ast.c"
 #include "src/debug.c"
 #include "src/utility.c"
 
 #include "src/type.c"
 
 #include "src/pipeline.c"
+#include "src/stats.c"
+#include "src/trace.c"
 
 #include "src/reader.c"
+#include "src/scan.c"
+#include "src/unicode.c"
+#include "src/lines.c"
 #include "src/lexer.c"
 #include "src/parser.c"
 #include "src/typechecker.c"
@@ -288,7 +355,7 @@ void populate_builtins(CompilationWorkspace* ws) {
   }
 
 
-  size_t builtin_node_id = -1;
+  uint32_t builtin_node_id = -1;
 
   {
     // @Hack Automatic interpretation of the `main` method.
@@ -323,61 +390,99 @@ void populate_builtins(CompilationWorkspace* ws) {
   }
 }
 
-DEFINE(Job, SENTINEL, { JOB_SENTINEL });
 void initialize_workspace(CompilationWorkspace* ws) {
-  initialize_queue(&ws->pipeline, 16, 16);
+  initialize_queue(&ws->pipeline, 256);
+  initialize_pool(&ws->jobs, sizeof(struct Job), 4, 64);
+  initialize_list(&ws->blockers, 1, 16);
   initialize_list(&ws->bytecode, 16, 64);
   initialize_list(&ws->initializers, 16, 512);
   initialize_list(&ws->global_scope.declarations, 16, 512);
   initialize_table(&ws->typeclasses, 256);
+  initialize_table(&ws->loaded_files, 64);
+  initialize_table(&ws->loaded_sources, 64);
+  initialize_arena(&ws->arena);
+  initialize_id_table(&ws->node_errors, 64);
+  initialize_id_table(&ws->waitlists, 64);
 
   populate_builtins(ws);
 
-  // Since we constantly re-enqueue incomplete work, particularly during
-  // typechecking, this sentinel value will allow us to detect unsolvable cycles
-  // and abort cleanly.
-  pipeline_emit(ws, SENTINEL);
-
   ws->entry = symbol_get(DEFAULT_ENTRY_POINT);
 }
 
-void report_errors(FileInfo* file, AstNode* node) {
+void report_errors(CompilationWorkspace* ws, FileInfo* file, AstNode* node) {
   if (!(node->flags & NODE_CONTAINS_ERROR)) return;
 
-  if (node->error == NULL) {
-    if (node->flags & NODE_CONTAINS_LHS) report_errors(file, node->lhs);
-    if (node->flags & NODE_CONTAINS_RHS) report_errors(file, node->rhs);
-    for (size_t i = 0; i < node->body_length; i++) report_errors(file, &node->body[i]);
+  String* error = node_error(ws, node);
+  if (error == NULL) {
+    AstNode* body = node_body(node);
+
+    if (node->flags & NODE_CONTAINS_LHS) report_errors(ws, file, node_lhs(node));
+    if (node->flags & NODE_CONTAINS_RHS) report_errors(ws, file, node_rhs(node));
+    for (size_t i = 0; i < node->body_length; i++) report_errors(ws, file, &body[i]);
   } else {
-    size_t line_no = node->from.line;
+    // An empty span marks the end of whatever preceded it (often a newline),
+    // so it's reported at the end of that line rather than the start of the next.
+    FileLocation from;
+    if (node->from == node->to && node->from > 0) {
+      from = file_locate(file, node->from - 1);
+      from.pos += 1;
+    } else {
+      from = file_locate(file, node->from);
+    }
+    size_t line_no = from.line;
 
     char* filename = to_zero_terminated_string(file->filename);
     String* line = &file->lines[line_no];
     char* line_str = to_zero_terminated_string(line);
 
+    // Spans are only underlined on their first line, though the mark may run
+    // one column past its end to point at the newline.
+    size_t mark_to = from.pos + (node->to - node->from);
+    if (mark_to > line->length + 1) mark_to = line->length + 1;
+    char* marks = calloc(mark_to > line->length ? mark_to + 1 : line->length + 1, 1);
+
     char* bold = "\e[1;37m";
     char* code = "\e[0;36m";
     char* err = "\e[0;31m";
     char* reset = "\e[0m";
 
-    printf("Error: "); print_string(node->error); printf("\n");
+    printf("Error: "); print_string(error); printf("\n");
     printf("In %s%s%s on line %s%zu%s\n\n", bold, filename, reset, bold, line_no + 1, reset);
     printf("> %s%s%s\n", code, line_str, reset);
 
-    for (int i = 0; i < line->length; i++) line_str[i] = ' ';
-    for (int i = node->from.pos; i < node->to.pos; i++) line_str[i] = '^';
-    printf("  %s%s%s\n", err, line_str, reset);
+    for (size_t i = 0; i < line->length; i++) marks[i] = ' ';
+    for (size_t i = from.pos; i < mark_to; i++) marks[i] = '^';
+    printf("  %s%s%s\n", err, marks, reset);
 
     free(filename);
     free(line_str);
+    free(marks);
   }
 }
 
 bool begin_compilation(CompilationWorkspace* ws) {
-  bool did_work = 1;
+  bool did_work = 0;
   int reported_errors = 0;
-  while (pipeline_has_jobs(ws)) {
+
+  stats_begin_compilation();
+
+  // Timestamps cost a pair of system calls per job, so they're only taken
+  // when the job is going to be reported on.
+  bool timed = __stats.format != STATS_NONE || __trace != NULL;
+
+  while (1) {
+    if (!pipeline_has_jobs(ws)) {
+      // Everything left is parked.  Normally those jobs are woken as their
+      // blockers are resolved, but if we've made any progress at all we give
+      // them each one more attempt; otherwise, we're stuck for good.
+      if (ws->parked == NULL || !did_work) break;
+      did_work = 0;
+      pipeline_unpark_all(ws);
+      continue;
+    }
+
     Job* job = pipeline_take_job(ws);
+    StatsTimestamp started = timed ? stats_now() : (StatsTimestamp) {0};
 
     if (job->type == JOB_READ) {
       did_work |= perform_read_job(job);
@@ -393,11 +498,11 @@ bool begin_compilation(CompilationWorkspace* ws) {
       did_work |= result;
 
       if (result) {
-        if (job->node->type == NODE_ASSIGNMENT && job->node->lhs->ident == job->ws->entry) {
+        if (job->node->type == NODE_ASSIGNMENT && job->node->declaration->ident == job->ws->entry) {
           // @Lazy This assumes that the rhs is a procedure!
           // job->ws->entry_id = job->node->rhs->id;
           size_t* bootstrap_bytecode = list_get(&job->ws->bytecode, 0);
-          *(bootstrap_bytecode + 1) = (size_t) job->node->lhs;
+          *(bootstrap_bytecode + 1) = (size_t) job->node->declaration;
 
           // @Hack Automatically running "main" in the interpreter.
           VmState* state = malloc(sizeof(VmState));
@@ -405,11 +510,14 @@ bool begin_compilation(CompilationWorkspace* ws) {
           state->sp = -1;
           state->ip = 0;
           state->id = 0;
-          state->waiting_on = job->node->lhs;
+          state->waiting_on = job->node->declaration;
+          state->retired = 0;
           pipeline_emit_execute_job(job->ws, state);
         }
       } else {
-        pipeline_emit(ws, job);
+        trace_record_job(job, started.wall, 0);
+        stats_record_job(job, started);
+        pipeline_park(ws, job);
         continue;
       }
 
@@ -421,54 +529,57 @@ bool begin_compilation(CompilationWorkspace* ws) {
       did_work |= result;
 
       if (!result) {
-        pipeline_emit(ws, job);
+        trace_record_job(job, started.wall, 0);
+        stats_record_job(job, started);
+        pipeline_park(ws, job);
         continue;
       }
 
     } else if (job->type == JOB_EXECUTE) {
       bool result = perform_execute_job(job);
+      stats_record_execution(job->vm_state);
       did_work |= result;
 
       if (!result) {
-        pipeline_emit(ws, job);
+        trace_record_job(job, started.wall, 0);
+        stats_record_job(job, started);
+        pipeline_park(ws, job);
         continue;
       }
 
     } else if (job->type == JOB_ABORT) {
-      report_errors(job->file, job->node);
+      report_errors(ws, job->file, job->node);
       reported_errors += 1;
       did_work = 1;
-
-    } else if (job->type == JOB_SENTINEL) {
-      if (!did_work) break;
-      did_work = 0;
-      pipeline_emit(ws, job);
-      continue;
     }
 
-    free(job);
+    trace_record_job(job, started.wall, 1);
+    stats_record_job(job, started);
+    pipeline_release_job(ws, job);
   }
 
-  // Drain the remaining pipeline jobs for error reporting.
+  stats_end_compilation();
+  __stats.arena_bytes = ws->arena.allocated;
+
+  // Drain the remaining parked jobs for error reporting.
+  pipeline_unpark_all(ws);
   while (pipeline_has_jobs(ws)) {
     Job* job = pipeline_take_job(ws);
 
-    if (job->type == JOB_SENTINEL) assert(0);
-
     reported_errors += 1;
     if (job->type == JOB_TYPECHECK) {
       // printf("«««««««»»»»»»»\n");
-      // print_ast_node_as_tree(job->file->lines, job->node);
+      // print_ast_node_as_tree(job->file->source, job->node);
       // printf("«««««««»»»»»»»\n");
       printf("\n\n");
-      report_errors(job->file, job->node);
+      report_errors(ws, job->file, job->node);
 
     } else if (job->type == JOB_BYTECODE) {
       // printf("«««««««»»»»»»»\n");
-      // print_ast_node_as_tree(job->file->lines, job->node);
+      // print_ast_node_as_tree(job->file->source, job->node);
       // printf("«««««««»»»»»»»\n");
       // printf("\n\n");
-      report_errors(job->file, job->node);
+      report_errors(ws, job->file, job->node);
 
     } else if (job->type == JOB_EXECUTE) {
       // @TODO Handle this?
@@ -479,7 +590,7 @@ bool begin_compilation(CompilationWorkspace* ws) {
       assert(0);
     }
 
-    free(job);
+    pipeline_release_job(ws, job);
   }
 
   if (reported_errors > 0) {
@@ -505,30 +616,79 @@ void crashbar(int nSignum, siginfo_t* si, void* vcontext) {
   exit(1);
 }
 
+int usage(char* program) {
+  fprintf(stderr, "Usage: %s [-j N] [--stats[=table|json]] [--trace=FILE] <filename>\n", program);
+  return 1;
+}
+
 int main(int argc, char** argv) {
-  if (argc == 1) {
-    fprintf(stderr, "Usage: %s <filename>\n", argv[0]);
-    return 1;
+  char* filename = NULL;
+  long thread_count = 1;
+  StatsFormat stats_format = STATS_NONE;
+  char* trace_filename = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "-j", 2) == 0) {
+      char* value = argv[i] + 2;
+      if (*value == '\0' && i + 1 < argc) value = argv[++i];
+
+      char* end;
+      thread_count = strtol(value, &end, 10);
+      if (*value == '\0' || *end != '\0' || thread_count < 0) return usage(argv[0]);
+
+      // `-j 0` uses every available core.
+      if (thread_count == 0) thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+    } else if (strcmp(argv[i], "--stats") == 0 || strcmp(argv[i], "--stats=table") == 0) {
+      stats_format = STATS_TABLE;
+    } else if (strcmp(argv[i], "--stats=json") == 0) {
+      stats_format = STATS_JSON;
+    } else if (strncmp(argv[i], "--trace=", 8) == 0 && argv[i][8] != '\0') {
+      trace_filename = argv[i] + 8;
+    } else if (strncmp(argv[i], "--", 2) == 0) {
+      return usage(argv[0]);
+    } else {
+      filename = argv[i];
+    }
   }
 
+  if (filename == NULL) return usage(argv[0]);
+
   struct sigaction action = {0};
   action.sa_flags = SA_SIGINFO;
   action.sa_sigaction = crashbar;
   sigaction(SIGSEGV, &action, NULL);
 
+  if (trace_filename) trace_begin();
+  __stats.format = stats_format;
+
   CompilationWorkspace workspace = {};
   // initialize_typechecker();  // @TODO Push this into the CompilationWorkspace.
   initialize_workspace(&workspace);
 
-  pipeline_emit_read_job(&workspace, &(String) { strlen(argv[1]), argv[1] });
+  // The main thread is always busy running the pipeline, so `-j N` asks for
+  // N - 1 additional workers.
+  if (thread_count > 1) workspace.scheduler = new_scheduler(thread_count - 1);
 
-  if (begin_compilation(&workspace)) {
-    fprintf(stderr, "Compiled %s.\n", argv[1]);
-    return 0;
+  pipeline_emit_read_job(&workspace, &(String) { strlen(filename), filename });
+
+  bool success = begin_compilation(&workspace);
+  if (workspace.scheduler) free_scheduler(workspace.scheduler);
+  free_arena(&workspace.arena);
+  free_id_table(&workspace.node_errors);
+  free_id_table(&workspace.waitlists);
+
+  if (success) {
+    fprintf(stderr, "Compiled %s.\n", filename);
   } else {
-    fprintf(stderr, "Unable to compile %s.\n", argv[1]);
-    return 1;
+    fprintf(stderr, "Unable to compile %s.\n", filename);
+  }
+
+  print_stats(stderr, stats_format);
+
+  if (trace_filename && !trace_write(trace_filename)) {
+    fprintf(stderr, "Unable to write trace to %s.\n", trace_filename);
   }
+  return success ? 0 : 1;
 }
 
 #endif
@@ -1,20 +1,4 @@
-// ** Constant Operators ** //
-
-DEFINE_STR(OP_DECLARE, ":");
-DEFINE_STR(OP_DECLARE_ASSIGN, ":=");
-DEFINE_STR(OP_ASSIGN, "=");
-DEFINE_STR(OP_FUNC_ARROW, "=>");
-DEFINE_STR(OP_OPEN_PAREN, "(");
-DEFINE_STR(OP_CLOSE_PAREN, ")");
-DEFINE_STR(OP_OPEN_BRACE, "{");
-DEFINE_STR(OP_CLOSE_BRACE, "}");
-DEFINE_STR(OP_COMMA, ",");
-DEFINE_STR(OP_NEWLINE, "\n");
-
-// ** Constant Directives ** //
-
-DEFINE_STR(DIRECTIVE_LOAD, "@load");
-DEFINE_STR(DIRECTIVE_CHAR, "@char");
+// Keywords, directives and operators are matched by Symbol; see `SeededSymbol`.
 
 // ** Constant Errors ** //
 
@@ -23,75 +7,125 @@ DEFINE_STR(ERR_EXPECTED_EXPRESSION, "Expected an expression");
 DEFINE_STR(ERR_EXPECTED_EOL, "Unexpected code following statement");
 DEFINE_STR(ERR_EXPECTED_CLOSE, "Unexpected code in argument list");
 DEFINE_STR(ERR_UNCLOSED_STRING, "String literal is unterminated");
+DEFINE_STR(ERR_LITERAL_TOO_LARGE, "Integer literal does not fit in 64 bits");
+DEFINE_STR(ERR_INVALID_UTF8, "Source is not valid UTF-8");
+DEFINE_STR(ERR_FILE_TOO_LARGE, "Source files are limited to 4GB");
 DEFINE_STR(ERR_UNDESCRIBED, "Error here");
 
 // ** Local Data Structures ** //
 
 typedef struct {
   CompilationWorkspace* ws;
+  FileInfo* file;
 
-  Token* tokens;
-  size_t length;
+  TokenizedFile* tokens;
   size_t pos;
+  size_t keep;  // Tokens before this one (the start of the current top-level statement) may be discarded.
 
-  Pool* nodes;
+  size_t node_count;
   Scope* scope;
+  List* scopes;  // Opened by the current top-level statement.
+
+  // Nodes of the current top-level statement, until it's flattened into the
+  // workspace's arena; see `flatten_ast`.  `parsed` holds them by number.
+  Arena nodes;
+  AstNode** parsed;
+  size_t parsed_length;
+  size_t parsed_capacity;
+
+  // Children of the lists being parsed; see `_parse_list`.
+  AstNode* scratch;
+  size_t scratch_length;
+  size_t scratch_capacity;
 } ParserState;
 
 
-void* new_parser_scope(Scope* parent) {
-  Scope* scope = malloc(sizeof(Scope));
+void* new_parser_scope(Arena* arena, Scope* parent) {
+  Scope* scope = arena_alloc(arena, sizeof(Scope));
   initialize_list(&scope->declarations, 1, 32);
   scope->parent = parent;
   return scope;
 }
 
+void push_parser_scope(ParserState* state) {
+  state->scope = new_parser_scope(&state->ws->arena, state->scope);
+  list_append(state->scopes, state->scope);
+}
+
 
 // ** State Manipulation Primitives ** //
 
+// Large files are lexed as we go: when we run out of tokens we pull in the
+// next chunk, first dropping those we're done with.  Backtracking never goes
+// further back than the start of the current top-level statement, and
+// `state->pos` counts tokens from the start of the file, so saved positions
+// survive the discarding.
 bool tokens_remain(ParserState* state) {
-  return state->pos < state->length;
+  TokenizedFile* tokens = state->tokens;
+
+  while (state->pos >= tokens->base + tokens->length) {
+    if (tokens->stream == NULL) return 0;
+
+    tokenized_file_discard(tokens, state->keep);
+    tokenized_file_pull(tokens);
+  }
+
+  return 1;
+}
+
+size_t _next_token(ParserState* state) {
+  tokens_remain(state);
+  return state->pos;
 }
 
-FileAddress token_start(Token t) {
-  return (FileAddress) { t.line, t.pos };
+FileAddress token_start(ParserState* state, size_t i) {
+  return token_offset(state->tokens, i);
 }
 
-FileAddress token_end(Token t) {
-  return (FileAddress) { t.line, t.pos + t.source.length };
+FileAddress token_end(ParserState* state, size_t i) {
+  return token_end_offset(state->tokens, i);
 }
 
-#define ACCEPTED (state->tokens[state->pos - 1])
-#define TOKEN    (state->tokens[state->pos])
+// Indices of the last accepted token, and the next one.
+#define ACCEPTED (state->pos - 1)
+#define TOKEN    (_next_token(state))
 
 
 // ** Parsing Primitives ** //
 
+// Nothing matches once the tokens run out.
+
 int peek(ParserState* state, TokenType type) {
-  return TOKEN.type == type;
+  return tokens_remain(state) && token_type(state->tokens, state->pos) == type;
+}
+
+// Keywords, directives and operators are seeded Symbols, so matching one is a
+// single comparison of the token's symbol; only then is its type checked
+// against the kinds of token the caller accepts.
+int _peek_symbol(ParserState* state, Symbol symbol, unsigned int types) {
+  if (!tokens_remain(state)) return 0;
+  if (token_symbol(state->tokens, state->pos) != symbol) return 0;
+  return (types >> token_type(state->tokens, state->pos)) & 1;
 }
 
-int peek_syntax_op(ParserState* state, String* op) {
-  if (TOKEN.type != TOKEN_SYNTAX_OPERATOR) return 0;
-  return string_equals(op, &TOKEN.source);
+int peek_syntax_op(ParserState* state, Symbol op) {
+  return _peek_symbol(state, op, 1 << TOKEN_SYNTAX_OPERATOR);
 }
 
-int peek_nonsyntax_op(ParserState* state, String* op) {
-  if (TOKEN.type != TOKEN_OPERATOR) return 0;
-  return string_equals(op, &TOKEN.source);
+int peek_nonsyntax_op(ParserState* state, Symbol op) {
+  return _peek_symbol(state, op, 1 << TOKEN_OPERATOR);
 }
 
-int peek_op(ParserState* state, String* op) {
-  return peek_syntax_op(state, op) || peek_nonsyntax_op(state, op);
+int peek_op(ParserState* state, Symbol op) {
+  return _peek_symbol(state, op, (1 << TOKEN_SYNTAX_OPERATOR) | (1 << TOKEN_OPERATOR));
 }
 
-int peek_keyword(ParserState* state, String* keyword) {
-  if (TOKEN.type != TOKEN_KEYWORD) return 0;
-  return string_equals(keyword, &TOKEN.source);
+int peek_keyword(ParserState* state, Symbol keyword) {
+  return _peek_symbol(state, keyword, 1 << TOKEN_KEYWORD);
 }
 
-int peek_directive(ParserState* state, String* directive) {
-  return (TOKEN.type == TOKEN_DIRECTIVE) && string_equals(&TOKEN.source, directive);
+int peek_directive(ParserState* state, Symbol directive) {
+  return _peek_symbol(state, directive, 1 << TOKEN_DIRECTIVE);
 }
 
 int accept(ParserState* state, TokenType type) {
@@ -101,35 +135,35 @@ int accept(ParserState* state, TokenType type) {
   return 1;
 }
 
-int accept_syntax_op(ParserState* state, String* op) {
+int accept_syntax_op(ParserState* state, Symbol op) {
   if (!peek_syntax_op(state, op)) return 0;
 
   state->pos += 1;
   return 1;
 }
 
-int accept_nonsyntax_op(ParserState* state, String* op) {
+int accept_nonsyntax_op(ParserState* state, Symbol op) {
   if (!peek_nonsyntax_op(state, op)) return 0;
 
   state->pos += 1;
   return 1;
 }
 
-int accept_op(ParserState* state, String* op) {
+int accept_op(ParserState* state, Symbol op) {
   if (!peek_op(state, op)) return 0;
 
   state->pos += 1;
   return 1;
 }
 
-int accept_keyword(ParserState* state, String* keyword) {
+int accept_keyword(ParserState* state, Symbol keyword) {
   if (!peek_keyword(state, keyword)) return 0;
 
   state->pos += 1;
   return 1;
 }
 
-int accept_directive(ParserState* state, String* directive) {
+int accept_directive(ParserState* state, Symbol directive) {
   if (!peek_directive(state, directive)) return 0;
 
   state->pos += 1;
@@ -209,60 +243,103 @@ bool test_top_level_directive(ParserState* state) {
 
 // ** Helpers ** //
 
+// Numbers a node of the current top-level statement; until the statement is
+// flattened, links between its nodes hold these numbers.
+void _register_node(ParserState* state, AstNode* node) {
+  if (state->parsed_length == state->parsed_capacity) {
+    state->parsed_capacity = state->parsed_capacity ? state->parsed_capacity * 2 : 256;
+    state->parsed = realloc(state->parsed, state->parsed_capacity * sizeof(AstNode*));
+  }
+
+  state->parsed[state->parsed_length++] = node;
+  node->index = state->parsed_length;
+}
+
+// The node linked to by `link`, one of a parsed node's `lhs`, `rhs` or `body`.
+AstNode* _parsed(ParserState* state, uint32_t link) {
+  return _ast_parsed(state->parsed, link);
+}
+
+AstNode* new_node(ParserState* state) {
+  state->node_count += 1;
+  AstNode* node = arena_alloc(&state->nodes, sizeof(AstNode));
+  _register_node(state, node);
+  return node;
+}
+
 void* init_node(AstNode* node, AstNodeType type) {
-  static size_t serial = 0;
+  static uint32_t serial = 0;
   node->type = type;
   node->flags = 0;
   node->id = serial++;
   node->bytecode_id = -1;
-  node->to.line = -1;
-  node->to.pos = -1;
+  node->to = -1;
+  node->lhs = 0;
+  node->rhs = 0;
+  node->body = 0;
   node->body_length = 0;
   node->typeclass = NULL;
-  node->error = NULL;
 
   return node;
 }
 
+// A list's children are gathered on a scratch stack shared by the whole parse,
+// and moved into the parser's arena in one go when the list closes.  Nested
+// lists push above their parent's children and pop back down before it
+// continues, so each list's children are contiguous.  The stack moves as it
+// grows, so children are each parsed into a local node, and only then pushed.
+void _scratch_push(ParserState* state, AstNode* node) {
+  if (state->scratch_length == state->scratch_capacity) {
+    state->scratch_capacity = state->scratch_capacity ? state->scratch_capacity * 2 : 64;
+    state->scratch = realloc(state->scratch, state->scratch_capacity * sizeof(AstNode));
+  }
+
+  state->scratch[state->scratch_length++] = *node;
+}
+
 AstNode* _parse_list(ParserState* state,
-                      String* open_operator,
-                      String* close_operator,
-                      String* separator,
+                      Symbol open_operator,
+                      Symbol close_operator,
+                      Symbol separator,
                       bool (*more)(ParserState* state),
                       void (*parse_node)(ParserState*, AstNode*)) {
-  AstNode* tuple = init_node(pool_get(state->nodes), NODE_COMPOUND);
-  tuple->from = token_start(TOKEN);
+  AstNode* tuple = init_node(new_node(state), NODE_COMPOUND);
+  tuple->from = token_start(state, TOKEN);
 
   assert(accept_op(state, open_operator));
   while (accept_op(state, OP_NEWLINE)) {}
 
   bool parse_errors = 0;
+  size_t base = state->scratch_length;
 
-  {
-    Pool* pool = new_pool(sizeof(AstNode), 2, 4);
-
-    while (tokens_remain(state) && more(state)) {
-      AstNode* node = pool_get(pool);
-      parse_node(state, node);
-      if (node->flags & NODE_CONTAINS_ERROR) parse_errors += 1;
-
-      if (separator != OP_NEWLINE) {
-        while (accept_op(state, OP_NEWLINE)) {}
-      }
+  while (tokens_remain(state) && more(state)) {
+    AstNode node;
+    parse_node(state, &node);
+    if (node.flags & NODE_CONTAINS_ERROR) parse_errors += 1;
+    _scratch_push(state, &node);
 
-      if (!accept_op(state, separator)) break;
+    if (separator != OP_NEWLINE) {
       while (accept_op(state, OP_NEWLINE)) {}
     }
 
-    tuple->body_length = pool->length;
-    tuple->body = pool_to_array(pool);
+    if (!accept_op(state, separator)) break;
+    while (accept_op(state, OP_NEWLINE)) {}
+  }
+
+  tuple->body_length = state->scratch_length - base;
+  __stats.ast_nodes += tuple->body_length;
+  if (tuple->body_length > 0) {
+    AstNode* body = arena_alloc(&state->nodes, tuple->body_length * sizeof(AstNode));
+    memcpy(body, state->scratch + base, tuple->body_length * sizeof(AstNode));
 
-    free_pool(pool);
+    for (size_t i = 0; i < tuple->body_length; i++) _register_node(state, &body[i]);
+    tuple->body = body[0].index;
   }
+  state->scratch_length = base;
 
   bool properly_balanced = accept_op(state, close_operator);
 
-  tuple->to = token_end(ACCEPTED);
+  tuple->to = token_end(state, ACCEPTED);
 
   if (parse_errors) tuple->flags |= NODE_CONTAINS_ERROR;
 
@@ -275,11 +352,11 @@ AstNode* _parse_list(ParserState* state,
       state->pos += 1;
     }
 
-    AstNode* error = init_node(pool_get(state->nodes), NODE_RECOVERY);
+    AstNode* error = init_node(new_node(state), NODE_RECOVERY);
     error->from = tuple->to;
-    error->to = token_end(ACCEPTED);
-    error->lhs = tuple;
-    error->error = ERR_EXPECTED_CLOSE; // @TODO: Parameterize?
+    error->to = token_end(state, ACCEPTED);
+    error->lhs = tuple->index;
+    node_set_error(state->ws, error, ERR_EXPECTED_CLOSE); // @TODO: Parameterize?
     error->flags |= NODE_CONTAINS_LHS;
     error->flags |= NODE_CONTAINS_ERROR;
 
@@ -308,27 +385,26 @@ void populate_conditional_node(AstNode* node, AstNode* cond, AstNode* branch) {
   // @TODO Error handling
   node->flags |= NODE_CONTAINS_LHS;
   node->body_length = 1;
-  node->lhs = cond;
-  node->body = branch;
+  node->lhs = cond->index;
+  node->body = branch->index;
 
   // node->from is populated by the caller
-  node->to = node->body->to;
-  node->flags |= (node->lhs->flags | node->body->flags) & NODE_CONTAINS_ERROR;
+  node->to = branch->to;
+  node->flags |= (cond->flags | branch->flags) & NODE_CONTAINS_ERROR;
 }
 
 void parse_type_node(ParserState* state, AstNode* node) {
   init_node(node, NODE_TYPE);
 
-  node->from = token_start(TOKEN);
+  node->from = token_start(state, TOKEN);
 
   if (accept(state, TOKEN_IDENTIFIER)) {
     node->flags |= NODE_CONTAINS_SOURCE;
-    node->source = ACCEPTED.source;
-    node->to = token_end(ACCEPTED);
+    node->to = token_end(state, ACCEPTED);
   } else {
     node->flags |= NODE_CONTAINS_ERROR;
-    node->error = ERR_EXPECTED_TYPE;
-    node->to = token_end(TOKEN);
+    node_set_error(state->ws, node, ERR_EXPECTED_TYPE);
+    node->to = token_end(state, TOKEN);
   }
 }
 
@@ -336,23 +412,24 @@ void parse_procedure_node(ParserState* state, AstNode* node) {
   // Initialized in `parse_expression_node`.
 
   node->flags = EXPR_PROCEDURE;
-  node->from = token_start(TOKEN);
+  node->from = token_start(state, TOKEN);
 
   // "Push" a new scope onto the stack.
-  state->scope = new_parser_scope(state->scope);
+  push_parser_scope(state);
 
-  node->lhs = parse_argument_declaration_tuple(state);
+  AstNode* arguments = parse_argument_declaration_tuple(state);
+  AstNode* returns;
 
   assert(accept_op(state, OP_FUNC_ARROW));
 
   if (peek_op(state, OP_OPEN_PAREN)) {
-    node->rhs = parse_type_tuple(state);
+    returns = parse_type_tuple(state);
 
   } else if (peek_op(state, OP_OPEN_BRACE)) {
-    node->rhs = init_node(pool_get(state->nodes), NODE_COMPOUND);
-    node->rhs->from = token_start(TOKEN);
-    node->rhs->to = token_start(TOKEN);
-    node->rhs->body_length = 0;
+    returns = init_node(new_node(state), NODE_COMPOUND);
+    returns->from = token_start(state, TOKEN);
+    returns->to = token_start(state, TOKEN);
+    returns->body_length = 0;
 
   } else if (test_type(state)) {
     AstNode* type = parse_type(state);
@@ -360,26 +437,30 @@ void parse_procedure_node(ParserState* state, AstNode* node) {
     // `test_type` should be guaranteeing a usable `type` node here.
     assert(!(type->flags & NODE_CONTAINS_ERROR));
 
-    node->rhs = init_node(pool_get(state->nodes), NODE_COMPOUND);
-    node->rhs->from = type->from;
-    node->rhs->to = type->to;
-    node->rhs->body_length = 1;
-    node->rhs->body = type;
+    returns = init_node(new_node(state), NODE_COMPOUND);
+    returns->from = type->from;
+    returns->to = type->to;
+    returns->body_length = 1;
+    returns->body = type->index;
 
   } else {
     // @TODO Actually recover from this error case.
     assert(0);
   }
 
+  AstNode* block = parse_code_block(state);
+  block->scope = state->scope;
+
+  node->lhs = arguments->index;
+  node->rhs = returns->index;
   node->body_length = 1;
-  node->body = parse_code_block(state);
-  node->body->scope = state->scope;
-  node->to = token_end(ACCEPTED);
+  node->body = block->index;
+  node->to = token_end(state, ACCEPTED);
   node->flags |= NODE_CONTAINS_LHS;
   node->flags |= NODE_CONTAINS_RHS;
-  node->flags |= (node->lhs->flags & NODE_CONTAINS_ERROR);
-  node->flags |= (node->rhs->flags & NODE_CONTAINS_ERROR);
-  node->flags |= (node->body->flags & NODE_CONTAINS_ERROR);
+  node->flags |= (arguments->flags & NODE_CONTAINS_ERROR);
+  node->flags |= (returns->flags & NODE_CONTAINS_ERROR);
+  node->flags |= (block->flags & NODE_CONTAINS_ERROR);
 
   // @UX Specialize error message if error is found in `lhs` or `rhs`.
 
@@ -392,13 +473,13 @@ void parse_conditional_node(ParserState* state, AstNode* node) {
   // @TODO Node initialization is deferred to `populate_conditional_node`, which
   //       feels uncomfortable.
 
-  node->from = token_start(TOKEN);
+  node->from = token_start(state, TOKEN);
   accept_keyword(state, KEYWORD_IF);
 
   AstNode* cond = parse_expression(state);
 
   // "Push" a new scope onto the stack.
-  state->scope = new_parser_scope(state->scope);
+  push_parser_scope(state);
 
   AstNode* branch = parse_code_block(state);
   branch->scope = state->scope;
@@ -412,17 +493,18 @@ void parse_conditional_node(ParserState* state, AstNode* node) {
 void parse_declaration_node(ParserState* state, AstNode* node) {
   init_node(node, NODE_DECLARATION);
 
-  node->from = token_start(TOKEN);
-  node->rhs = NULL;
+  node->from = token_start(state, TOKEN);
+  node->rhs = 0;
 
   // `test_declaration` should be guaranteeing a usable identifier here.
   assert(accept(state, TOKEN_IDENTIFIER));
-  node->ident = symbol_get(&ACCEPTED.source);
+  node->ident = token_symbol(state->tokens, ACCEPTED);
   node->flags |= NODE_CONTAINS_IDENT;
 
   if (accept_op(state, OP_DECLARE)) {
-    node->rhs = parse_type(state);
-    node->flags |= (node->rhs->flags & NODE_CONTAINS_ERROR);
+    AstNode* type = parse_type(state);
+    node->rhs = type->index;
+    node->flags |= (type->flags & NODE_CONTAINS_ERROR);
     node->flags |= NODE_CONTAINS_RHS;
 
   } else if (peek_op(state, OP_DECLARE_ASSIGN)) {
@@ -432,22 +514,23 @@ void parse_declaration_node(ParserState* state, AstNode* node) {
     assert(0);
   }
 
-  node->to = token_end(ACCEPTED);
+  node->to = token_end(state, ACCEPTED);
 }
 
 void parse_return_node(ParserState* state, AstNode* node) {
   init_node(node, NODE_RETURN);
 
-  node->from = token_start(TOKEN);
+  node->from = token_start(state, TOKEN);
   assert(accept_keyword(state, KEYWORD_RETURN));
 
   if (!peek_op(state, OP_NEWLINE)) {
-    node->rhs = parse_expression(state);
-    node->flags |= (node->rhs->flags & NODE_CONTAINS_ERROR);
+    AstNode* value = parse_expression(state);
+    node->rhs = value->index;
+    node->flags |= (value->flags & NODE_CONTAINS_ERROR);
     node->flags |= NODE_CONTAINS_RHS;
   }
 
-  node->to = token_end(ACCEPTED);
+  node->to = token_end(state, ACCEPTED);
 }
 
 void parse_expression_node(ParserState* state, AstNode* node) {
@@ -455,43 +538,50 @@ void parse_expression_node(ParserState* state, AstNode* node) {
 
   if (accept(state, TOKEN_LITERAL)) {
     // @TODO Extract this?
-    node->flags = EXPR_LITERAL | ACCEPTED.literal_type | NODE_CONTAINS_SOURCE;
-    node->from = token_start(ACCEPTED);
-    node->to = token_end(ACCEPTED);
-    node->source = ACCEPTED.source;
+    node->flags = EXPR_LITERAL | token_literal_type(state->tokens, ACCEPTED) | NODE_CONTAINS_SOURCE;
+    node->from = token_start(state, ACCEPTED);
+    node->to = token_end(state, ACCEPTED);
+
+    // Integer literals were already evaluated by the lexer.
+    if (node->flags & (IS_DECIMAL_LITERAL | IS_HEX_LITERAL | IS_BINARY_LITERAL)) {
+      node->flags |= token_literal_width(state->tokens, ACCEPTED);
+      node->int_value = token_value(state->tokens, ACCEPTED);
+    }
 
-    if (!ACCEPTED.is_well_formed) {
+    if (!token_is_well_formed(state->tokens, ACCEPTED)) {
       node->flags |= NODE_CONTAINS_ERROR;
 
-      if (ACCEPTED.literal_type & IS_STRING_LITERAL) {
-        node->error = ERR_UNCLOSED_STRING;
-      } else {
-        // We don't presently test well-formedness for other literal types.
+      if (token_literal_type(state->tokens, ACCEPTED) & IS_STRING_LITERAL) {
+        node_set_error(state->ws, node, ERR_UNCLOSED_STRING);
+      } else if (token_literal_type(state->tokens, ACCEPTED) & IS_FRACTIONAL_LITERAL) {
+        // We don't presently test well-formedness for fractional literals.
         assert(0);
+      } else {
+        node_set_error(state->ws, node, ERR_LITERAL_TOO_LARGE);
       }
     }
 
   } else if (accept(state, TOKEN_IDENTIFIER)) {
-    Symbol name = symbol_get(&ACCEPTED.source);
-    FileAddress start = token_start(ACCEPTED);
+    Symbol name = token_symbol(state->tokens, ACCEPTED);
+    FileAddress start = token_start(state, ACCEPTED);
 
     if (peek_op(state, OP_OPEN_PAREN)) {
       AstNode* arguments = parse_expression_tuple(state);
 
       node->flags = EXPR_CALL;
       node->from = start;
-      node->to = token_end(ACCEPTED);
+      node->to = token_end(state, ACCEPTED);
       node->ident = name;
-      node->rhs = arguments;
+      node->rhs = arguments->index;
       node->scope = state->scope;
-      node->flags |= (node->rhs->flags & NODE_CONTAINS_ERROR);
+      node->flags |= (arguments->flags & NODE_CONTAINS_ERROR);
       node->flags |= NODE_CONTAINS_IDENT;
       node->flags |= NODE_CONTAINS_RHS;
 
     } else {
       node->flags = EXPR_IDENT;
       node->from = start;
-      node->to = token_end(ACCEPTED);
+      node->to = token_end(state, ACCEPTED);
       node->ident = name;
       node->scope = state->scope;
       node->flags |= NODE_CONTAINS_IDENT;
@@ -501,13 +591,13 @@ void parse_expression_node(ParserState* state, AstNode* node) {
     parse_procedure_node(state, node);
 
   } else if (accept_directive(state, DIRECTIVE_CHAR)) {
-    node->from = token_start(ACCEPTED);
+    node->from = token_start(state, ACCEPTED);
 
     if (!peek_op(state, OP_OPEN_PAREN)) {
       // @TODO Report error - expected arguments.
       node->flags |= NODE_CONTAINS_ERROR;
-      node->error = ERR_UNDESCRIBED;
-      node->to = token_end(ACCEPTED);
+      node_set_error(state->ws, node, ERR_UNDESCRIBED);
+      node->to = token_end(state, ACCEPTED);
       return;
     }
 
@@ -515,41 +605,42 @@ void parse_expression_node(ParserState* state, AstNode* node) {
     if (arguments->body_length != 1) {
       // @TODO Report error - expected one argument.
       node->flags |= NODE_CONTAINS_ERROR;
-      node->error = ERR_UNDESCRIBED;
-      node->to = token_end(ACCEPTED);
+      node_set_error(state->ws, node, ERR_UNDESCRIBED);
+      node->to = token_end(state, ACCEPTED);
       return;
     }
 
-    AstNode* expr = arguments->body;
+    AstNode* expr = _parsed(state, arguments->body);
     if (!(expr->flags & (EXPR_LITERAL | IS_STRING_LITERAL))) {
       // @TODO Report error - expected a string literal.
       node->flags |= NODE_CONTAINS_ERROR;
-      node->error = ERR_UNDESCRIBED;
-      node->to = token_end(ACCEPTED);
+      node_set_error(state->ws, node, ERR_UNDESCRIBED);
+      node->to = token_end(state, ACCEPTED);
       return;
     }
 
-    String* str = unescape_string_literal(&expr->source);
+    String literal = node_source(state->file->source, expr);
+    String* str = unescape_string_literal(&literal);
     if (str->length != 1) {
       // @TODO Report error - expected a single byte string.
       node->flags |= NODE_CONTAINS_ERROR;
-      node->error = ERR_UNDESCRIBED;
-      node->to = token_end(ACCEPTED);
+      node_set_error(state->ws, node, ERR_UNDESCRIBED);
+      node->to = token_end(state, ACCEPTED);
       return;
     }
 
     node->flags |= EXPR_LITERAL;
     node->flags |= IS_DECIMAL_LITERAL;
     node->int_value = str->data[0];
-    node->to = token_end(ACCEPTED);
+    node->to = token_end(state, ACCEPTED);
 
     // @TODO I'm not sure I like eagerly typing this...
     node->typeclass = type_find(state->ws, STR_BYTE);
 
   } else {
-    node->from = token_start(TOKEN);
-    node->to = token_end(TOKEN);
-    node->error = ERR_EXPECTED_EXPRESSION;
+    node->from = token_start(state, TOKEN);
+    node->to = token_end(state, TOKEN);
+    node_set_error(state->ws, node, ERR_EXPECTED_EXPRESSION);
     node->flags |= NODE_CONTAINS_ERROR;
   }
 }
@@ -565,13 +656,13 @@ void parse_assignment_node(ParserState* state, AstNode* node) {
 
     node->from = decl->from;
     node->scope = state->scope;
-    node->to = token_end(ACCEPTED);
-    node->lhs = decl;
-    node->rhs = value;
+    node->to = token_end(state, ACCEPTED);
+    node->lhs = decl->index;
+    node->rhs = value->index;
     node->flags |= NODE_CONTAINS_LHS;
     node->flags |= NODE_CONTAINS_RHS;
-    node->flags |= (node->lhs->flags & NODE_CONTAINS_ERROR);
-    node->flags |= (node->rhs->flags & NODE_CONTAINS_ERROR);
+    node->flags |= (decl->flags & NODE_CONTAINS_ERROR);
+    node->flags |= (value->flags & NODE_CONTAINS_ERROR);
 
   } else {
     AstNode* expr = parse_expression(state);
@@ -580,13 +671,13 @@ void parse_assignment_node(ParserState* state, AstNode* node) {
 
     node->from = expr->from;
     node->scope = state->scope;
-    node->to = token_end(ACCEPTED);
-    node->lhs = expr;
-    node->rhs = value;
+    node->to = token_end(state, ACCEPTED);
+    node->lhs = expr->index;
+    node->rhs = value->index;
     node->flags |= NODE_CONTAINS_LHS;
     node->flags |= NODE_CONTAINS_RHS;
-    node->flags |= (node->lhs->flags & NODE_CONTAINS_ERROR);
-    node->flags |= (node->rhs->flags & NODE_CONTAINS_ERROR);
+    node->flags |= (expr->flags & NODE_CONTAINS_ERROR);
+    node->flags |= (value->flags & NODE_CONTAINS_ERROR);
   }
 }
 
@@ -604,11 +695,11 @@ void parse_argument_declaration_node(ParserState* state, AstNode* node) {
 // LOOP = "loop" CODE_BLOCK
 void parse_loop_node(ParserState* state, AstNode* node) {
   init_node(node, NODE_LOOP);
-  node->from = token_start(TOKEN);
+  node->from = token_start(state, TOKEN);
   accept_keyword(state, KEYWORD_LOOP);
 
   // "Push" a new scope onto the stack.
-  state->scope = new_parser_scope(state->scope);
+  push_parser_scope(state);
 
   AstNode* block = parse_code_block(state);
   block->scope = state->scope;
@@ -617,7 +708,7 @@ void parse_loop_node(ParserState* state, AstNode* node) {
   state->scope = state->scope->parent;
 
   node->body_length = 1;
-  node->body = block;
+  node->body = block->index;
   node->flags |= (block->flags) & NODE_CONTAINS_ERROR;
   node->to = block->to;
 }
@@ -651,9 +742,9 @@ void parse_statement_node(ParserState* state, AstNode* node) {
   } else if (peek_keyword(state, KEYWORD_BREAK)) {
     init_node(node, NODE_BREAK);
 
-    node->from = token_start(TOKEN);
+    node->from = token_start(state, TOKEN);
     accept_keyword(state, KEYWORD_BREAK);
-    node->to = token_start(TOKEN);
+    node->to = token_start(state, TOKEN);
 
   } else {
     parse_expression_node(state, node);
@@ -661,12 +752,14 @@ void parse_statement_node(ParserState* state, AstNode* node) {
     // @TODO Postfix conditionals (and others?) should be pulled out into a
     //       separate function, probably.
     if (peek_keyword(state, KEYWORD_IF)) {
-      AstNode* branch = pool_get(state->nodes);
+      AstNode* branch = new_node(state);
+      uint32_t index = branch->index;
       *branch = *node;
+      branch->index = index;
 
       accept_keyword(state, KEYWORD_IF);
 
-      AstNode* test = pool_get(state->nodes);
+      AstNode* test = new_node(state);
       parse_expression_node(state, test);
 
       populate_conditional_node(node, test, branch);
@@ -678,7 +771,7 @@ void parse_statement_node(ParserState* state, AstNode* node) {
 //      | TYPE_TUPLE "=>" TYPE          @TODO
 //      | TYPE_TUPLE "=>" TYPE_TUPLE    @TODO
 AstNode* parse_type(ParserState* state) {
-  AstNode* type = pool_get(state->nodes);
+  AstNode* type = new_node(state);
   parse_type_node(state, type);
   return type;
 }
@@ -695,11 +788,11 @@ AstNode* parse_argument_declaration_tuple(ParserState* state) {
   AstNode* tuple = _parse_list(state, OP_OPEN_PAREN, OP_CLOSE_PAREN, OP_COMMA, test_declaration, parse_argument_declaration_node);
 
   // We have to do this insane juggling here, because we can't rely on the
-  // tuple's pool-allocated node pointers being stable.
+  // tuple's node pointers being stable until it's complete.
   for (size_t i = 0; i < tuple->body_length; i++) {
-    AstNode* node = &tuple->body[i];
+    AstNode* node = _parsed(state, tuple->body) + i;
     node->int_value = i;
-    if (node->type == NODE_ASSIGNMENT) node = node->lhs;
+    if (node->type == NODE_ASSIGNMENT) node = _parsed(state, node->lhs);
     if (node->type == NODE_DECLARATION) list_append(&state->scope->declarations, node);
   }
 
@@ -719,10 +812,10 @@ AstNode* parse_code_block(ParserState* state) {
   AstNode* block = _parse_list(state, OP_OPEN_BRACE, OP_CLOSE_BRACE, OP_NEWLINE, test_not_end_of_block, parse_statement_node);
 
   // We have to do this insane juggling here, because we can't rely on the
-  // tuple's pool-allocated node pointers being stable.
+  // tuple's node pointers being stable until it's complete.
   for (size_t i = 0; i < block->body_length; i++) {
-    AstNode* node = &block->body[i];
-    if (node->type == NODE_ASSIGNMENT) node = node->lhs;
+    AstNode* node = _parsed(state, block->body) + i;
+    if (node->type == NODE_ASSIGNMENT) node = _parsed(state, node->lhs);
     if (node->type == NODE_DECLARATION) list_append(&state->scope->declarations, node);
   }
 
@@ -737,7 +830,7 @@ AstNode* parse_code_block(ParserState* state) {
 //           | DECLARATION_TUPLE "=>" TYPE_TUPLE CODE_BLOCK
 //           | DECLARATION_TUPLE "=>" NAMED_TYPE_TUPLE CODE_BLOCK    @TODO
 AstNode* parse_procedure(ParserState* state) {
-  AstNode* proc = pool_get(state->nodes);
+  AstNode* proc = new_node(state);
   parse_procedure_node(state, proc);
   return proc;
 }
@@ -747,7 +840,7 @@ AstNode* parse_procedure(ParserState* state) {
 //            | Identifier
 //            | PROCEDURE
 AstNode* parse_expression(ParserState* state) {
-  AstNode* expr = pool_get(state->nodes);
+  AstNode* expr = new_node(state);
   parse_expression_node(state, expr);
   return expr;
 }
@@ -756,7 +849,7 @@ AstNode* parse_expression(ParserState* state) {
 //             | Identifier ":" TYPE "=" EXPRESSION
 //             | Identifier ":=" EXPRESSION
 AstNode* parse_declaration(ParserState* state) {
-  AstNode* decl = pool_get(state->nodes);
+  AstNode* decl = new_node(state);
   parse_declaration_node(state, decl);
 
   return decl;
@@ -765,7 +858,7 @@ AstNode* parse_declaration(ParserState* state) {
 // ASSIGNMENT = Identifier "=" EXPRESSION
 //            | DECLARATION ":=" EXPRESSION
 AstNode* parse_assignment(ParserState* state) {
-  AstNode* assignment = pool_get(state->nodes);
+  AstNode* assignment = new_node(state);
   parse_assignment_node(state, assignment);
   return assignment;
 }
@@ -774,18 +867,19 @@ AstNode* parse_assignment(ParserState* state) {
 AstNode* parse_top_level_directive(CompilationWorkspace* ws, ParserState* state) {
   if (accept_directive(state, DIRECTIVE_LOAD)) {
     AstNode* args = parse_expression_tuple(state);
-    if (args->error) return args;
+    if (node_error(ws, args)) return args;
 
     if (args->body_length != 1) {
       // @TODO Report error – wrong number of arguments.
     }
 
-    AstNode* file = &args->body[0];
+    AstNode* file = _parsed(state, args->body);
     if (!(file->type == NODE_EXPRESSION && file->flags & EXPR_LITERAL && file->flags & IS_STRING_LITERAL)) {
       // @TODO Report error - wrong argument type.
     }
 
-    String* filename = unescape_string_literal(&file->source);
+    String literal = node_source(state->file->source, file);
+    String* filename = unescape_string_literal(&literal);
     pipeline_emit_read_job(ws, filename);
   }
   return NULL;
@@ -801,7 +895,7 @@ AstNode* parse_top_level(ParserState* state) {
     node = parse_assignment(state);
 
     AstNode* decl = node;
-    if (decl->type == NODE_ASSIGNMENT) decl = decl->lhs;
+    if (decl->type == NODE_ASSIGNMENT) decl = _parsed(state, decl->lhs);
     if (decl->type == NODE_DECLARATION) list_append(&state->scope->declarations, decl);
   } else if (test_declaration(state)) {
     node = parse_declaration(state);
@@ -809,7 +903,7 @@ AstNode* parse_top_level(ParserState* state) {
   } else if (test_top_level_directive(state)) {
     parse_top_level_directive(state->ws, state);
   } else {
-    printf("Invalid top-level expression on line %zu!", TOKEN.line);
+    printf("Invalid top-level expression on line %zu!", file_locate(state->file, token_start(state, TOKEN)).line);
     assert(0);
   }
 
@@ -818,17 +912,17 @@ AstNode* parse_top_level(ParserState* state) {
       // @TODO More robustly seek past the error.
       while (tokens_remain(state) && !peek_op(state, OP_NEWLINE)) state->pos += 1;
     } else {
-      AstNode* error = init_node(pool_get(state->nodes), NODE_RECOVERY);
-      error->from = token_start(TOKEN);
-      error->lhs = node;
-      error->error = ERR_EXPECTED_EOL;
+      AstNode* error = init_node(new_node(state), NODE_RECOVERY);
+      error->from = token_start(state, TOKEN);
+      error->lhs = node->index;
+      node_set_error(state->ws, error, ERR_EXPECTED_EOL);
       error->flags |= NODE_CONTAINS_LHS;
       error->flags |= NODE_CONTAINS_ERROR;
 
       // @TODO More robustly seek past the error.
       while (!peek_op(state, OP_NEWLINE)) state->pos += 1;
 
-      error->to = token_end(ACCEPTED);
+      error->to = token_end(state, ACCEPTED);
       return error;
     }
   }
@@ -836,15 +930,75 @@ AstNode* parse_top_level(ParserState* state) {
   return node;
 }
 
+void _forward_declarations(List* declarations, size_t from) {
+  for (size_t i = from; i < declarations->length; i++) {
+    list_set(declarations, i, ast_forwarded(list_get(declarations, i)));
+  }
+}
+
+// Moves a finished top-level statement into the workspace's arena, where it
+// lives on through the later passes, and updates the scopes which recorded
+// its declarations.  `declared` is the number of top-level declarations that
+// preceded it.
+AstNode* _finish_top_level(ParserState* state, AstNode* node, size_t declared) {
+  node = flatten_ast(&state->ws->arena, state->parsed, node);
+
+  _forward_declarations(&state->scope->declarations, declared);
+  for (size_t i = 0; i < state->scopes->length; i++) {
+    Scope* scope = list_get(state->scopes, i);
+    _forward_declarations(&scope->declarations, 0);
+  }
+
+  return node;
+}
+
 bool perform_parse_job(Job* job) {
   ParserState state = {0};
   state.ws = job->ws;
-  state.tokens = job->tokens->tokens;
-  state.length = job->tokens->length;
-  state.nodes = new_pool(sizeof(AstNode), 16, 64);
-  state.scope = new_parser_scope(&job->ws->global_scope);
+  state.file = job->file;
+  state.tokens = job->tokens;
+  state.scope = new_parser_scope(&job->ws->arena, &job->ws->global_scope);
+  state.scopes = new_list(1, 64);
+  initialize_arena(&state.nodes);
+
+  // The lexer's tokens are meaningless around invalid UTF-8, so we report the
+  // first bad byte instead of parsing any further.  (Files small enough to be
+  // lexed in one chunk are checked before anything in them is parsed.)  Files
+  // too large for a FileAddress are rejected before any tokens are pulled.
+  String* source = job->file->source;
+  bool too_large = source->length > UINT32_MAX;
+  while (too_large || tokens_remain(&state) || job->tokens->invalid_utf8 < source->length) {
+    state.keep = state.pos;
+    state.scopes->length = 0;
+    state.parsed_length = 0;
+    arena_reset(&state.nodes);
+
+    size_t declared = state.scope->declarations.length;
+
+    if (too_large) {
+      AstNode* error = init_node(new_node(&state), NODE_RECOVERY);
+      error->from = 0;
+      error->to = 1;
+      node_set_error(job->ws, error, ERR_FILE_TOO_LARGE);
+      error->flags |= NODE_CONTAINS_ERROR;
+
+      error = _finish_top_level(&state, error, declared);
+      pipeline_emit_abort_job(job->ws, job->file, error);
+      break;
+    }
+
+    if (job->tokens->invalid_utf8 < source->length) {
+      AstNode* error = init_node(new_node(&state), NODE_RECOVERY);
+      error->from = job->tokens->invalid_utf8;
+      error->to = error->from + 1;
+      node_set_error(job->ws, error, ERR_INVALID_UTF8);
+      error->flags |= NODE_CONTAINS_ERROR;
+
+      error = _finish_top_level(&state, error, declared);
+      pipeline_emit_abort_job(job->ws, job->file, error);
+      break;
+    }
 
-  while (tokens_remain(&state)) {
     if (accept_op(&state, OP_NEWLINE)) {
       // Move on, nothing to see here.
 
@@ -852,19 +1006,34 @@ bool perform_parse_job(Job* job) {
       AstNode* node = parse_top_level(&state);
       if (node == NULL) continue;
 
+      node = _finish_top_level(&state, node, declared);
+
       if (node->flags & NODE_CONTAINS_ERROR) {
         pipeline_emit_abort_job(job->ws, job->file, node);
       } else {
         pipeline_emit_typecheck_job(job->ws, job->file, node);
       }
 
-      // print_ast_node_as_sexpr(job->file->lines, node, 0); printf("\n");
-      // print_ast_node_as_tree(job->file->lines, node);
+      // print_ast_node_as_sexpr(job->file->source, node, 0); printf("\n");
+      // print_ast_node_as_tree(job->file->source, node);
     }
   }
 
-  // print_declaration_list_as_sexpr(job->file->lines, &state->scope.declarations);
-  // print_declaration_list_as_tree(job->file->lines, &state->scope.declarations);
+  free(state.scratch);
+  free_list(state.scopes);
+  free(state.parsed);
+  free_arena(&state.nodes);
+
+  // We may have stopped early, with chunks still being lexed.
+  if (job->tokens->stream != NULL) {
+    free_token_stream(job->tokens->stream);
+    job->tokens->stream = NULL;
+  }
+
+  __stats.ast_nodes += state.node_count;
+
+  // print_declaration_list_as_sexpr(job->file->source, &state->scope.declarations);
+  // print_declaration_list_as_tree(job->file->source, &state->scope.declarations);
 
   return 1;
 }
@@ -1,5 +1,4 @@
 typedef enum {
-  JOB_SENTINEL,
   JOB_READ,
   JOB_LEX,
   JOB_PARSE,
@@ -10,8 +9,20 @@ typedef enum {
   JOB_ABORT,
 } JobType;
 
-typedef struct {
+typedef struct ParkingTicket {
+  struct Job* job;    // NULL once the job has been woken.
+  size_t references;  // Waitlists still holding this ticket.
+} ParkingTicket;
+
+typedef struct Waiter {
+  ParkingTicket* ticket;
+  struct Waiter* next;
+} Waiter;
+
+typedef struct Job {
   JobType type;
+  size_t serial;
+  size_t attempts;  // Times the job has been run; only non-zero for retries.
   CompilationWorkspace* ws;
   FileInfo* file;
   union {
@@ -20,10 +31,46 @@ typedef struct {
     String* source;
     VmState* vm_state;
   };
+
+  ParkingTicket* ticket;     // NULL unless the job is parked.
+  struct Job* parked_prev;
+  struct Job* parked_next;   // Also links the free list of released jobs.
 } Job;
 
+void perform_prefetch_task(void* data);
+
+
+// ** Job Allocation ** //
+
+// Jobs are carved out of a pool, and released jobs are kept on a free list for
+// reuse; they're only ever created and released on the main thread.
+
+Job* pipeline_new_job(CompilationWorkspace* ws, JobType type, FileInfo* file) {
+  Job* job = ws->free_jobs;
+
+  if (job != NULL) {
+    ws->free_jobs = job->parked_next;
+  } else {
+    job = pool_get(&ws->jobs);
+  }
+
+  *job = (Job) { type };
+  job->ws = ws;
+  job->file = file;
+
+  return job;
+}
+
+void pipeline_release_job(CompilationWorkspace* ws, Job* job) {
+  job->parked_next = ws->free_jobs;
+  ws->free_jobs = job;
+}
+
 
 void pipeline_emit(CompilationWorkspace* ws, Job* job) {
+  static size_t serial = 0;  // Orders jobs for error reporting.
+  if (job->serial == 0) job->serial = ++serial;
+
   queue_add(&ws->pipeline, job);
 }
 
@@ -35,89 +82,248 @@ Job* pipeline_take_job(CompilationWorkspace* ws) {
   return queue_pull(&ws->pipeline);
 }
 
+
+// ** Parking ** //
+
+// Rather than spinning on jobs which can't yet make progress, a job that fails
+// is parked on the nodes it's waiting on (as recorded by `pipeline_block_on`),
+// and is only re-queued once one of them is resolved.
+
+// Records that the running job is waiting on `node`.  A NULL node signifies an
+// identifier that hasn't yet been declared.
+void pipeline_block_on(CompilationWorkspace* ws, AstNode* node) {
+  list_append(&ws->blockers, node);
+}
+
+bool _pipeline_blocker_resolved(Job* job, AstNode* node) {
+  if (node == NULL) return 0;
+
+  switch (job->type) {
+    case JOB_TYPECHECK: return node->typeclass != NULL;
+    case JOB_BYTECODE: return node->bytecode_id != -1;
+    case JOB_EXECUTE: return (node->flags & NODE_INITIALIZED) != 0;
+    default: return 0;
+  }
+}
+
+void _pipeline_unpark(CompilationWorkspace* ws, Job* job) {
+  if (job->parked_prev) job->parked_prev->parked_next = job->parked_next;
+  if (job->parked_next) job->parked_next->parked_prev = job->parked_prev;
+  if (ws->parked == job) ws->parked = job->parked_next;
+
+  ParkingTicket* ticket = job->ticket;
+  ticket->job = NULL;
+  if (ticket->references == 0) free(ticket);
+
+  job->ticket = NULL;
+  job->parked_prev = NULL;
+  job->parked_next = NULL;
+
+  pipeline_emit(ws, job);
+}
+
+void pipeline_park(CompilationWorkspace* ws, Job* job) {
+  // The job may have resolved its own blockers before giving up (e.g. a block
+  // which uses a variable before declaring it); if so, we retry immediately.
+  for (size_t i = 0; i < ws->blockers.length; i++) {
+    if (_pipeline_blocker_resolved(job, list_get(&ws->blockers, i))) {
+      ws->blockers.length = 0;
+      pipeline_emit(ws, job);
+      return;
+    }
+  }
+
+  ParkingTicket* ticket = malloc(sizeof(ParkingTicket));
+  ticket->job = job;
+  ticket->references = 0;
+
+  for (size_t i = 0; i < ws->blockers.length; i++) {
+    AstNode* node = list_get(&ws->blockers, i);
+
+    Waiter* waiter = malloc(sizeof(Waiter));
+    waiter->ticket = ticket;
+    if (node) {
+      waiter->next = id_table_find(&ws->waitlists, node->id);
+      id_table_add(&ws->waitlists, node->id, waiter);
+    } else {
+      waiter->next = ws->unresolved;
+      ws->unresolved = waiter;
+    }
+    ticket->references += 1;
+  }
+  ws->blockers.length = 0;
+
+  job->ticket = ticket;
+  job->parked_prev = NULL;
+  job->parked_next = ws->parked;
+  if (ws->parked) ws->parked->parked_prev = job;
+  ws->parked = job;
+}
+
+void _pipeline_wake_waitlist(CompilationWorkspace* ws, Waiter* waiter) {
+  while (waiter != NULL) {
+    Waiter* next = waiter->next;
+    ParkingTicket* ticket = waiter->ticket;
+
+    ticket->references -= 1;
+    if (ticket->job != NULL) {
+      _pipeline_unpark(ws, ticket->job);
+    } else if (ticket->references == 0) {
+      free(ticket);
+    }
+
+    free(waiter);
+    waiter = next;
+  }
+}
+
+// Re-queues every job waiting on `node`.
+void pipeline_wake(CompilationWorkspace* ws, AstNode* node) {
+  Waiter* waiter = id_table_find(&ws->waitlists, node->id);
+  if (waiter == NULL) return;
+
+  id_table_add(&ws->waitlists, node->id, NULL);
+  _pipeline_wake_waitlist(ws, waiter);
+}
+
+// Re-queues every job waiting on an undeclared identifier.
+void pipeline_wake_unresolved(CompilationWorkspace* ws) {
+  Waiter* waiter = ws->unresolved;
+  ws->unresolved = NULL;
+  if (waiter) _pipeline_wake_waitlist(ws, waiter);
+}
+
+int _compare_job_serials(const void* a, const void* b) {
+  size_t x = (*(Job**) a)->serial;
+  size_t y = (*(Job**) b)->serial;
+  return (x > y) - (x < y);
+}
+
+// Re-queues every parked job, in the order the jobs were first emitted.
+void pipeline_unpark_all(CompilationWorkspace* ws) {
+  size_t count = 0;
+  for (Job* job = ws->parked; job != NULL; job = job->parked_next) count += 1;
+  if (count == 0) return;
+
+  Job** jobs = malloc(count * sizeof(Job*));
+  count = 0;
+  for (Job* job = ws->parked; job != NULL; job = job->parked_next) jobs[count++] = job;
+
+  qsort(jobs, count, sizeof(Job*), _compare_job_serials);
+  for (size_t i = 0; i < count; i++) _pipeline_unpark(ws, jobs[i]);
+
+  free(jobs);
+}
+
+// Registers the file as loaded, returning zero if it already was.  Files are
+// identified both by canonical path and by device and inode, so symlinks and
+// hard links to the same file are caught too.
+//
+// Newly claimed files are also handed to the kernel for readahead right away;
+// all the loads discovered while parsing a file are claimed back-to-back, so
+// their reads are in flight together long before their read jobs come up.
+int _pipeline_claim_file(CompilationWorkspace* ws, FileInfo* file) {
+  char* filename = to_zero_terminated_string(file->filename);
+  char* canonical = realpath(filename, NULL);
+  free(filename);
+
+  // Let the read job report missing files.  (Opening without blocking keeps
+  // FIFOs from stalling the parser here.)
+  int fd = canonical == NULL ? -1 : open(canonical, O_RDONLY | O_NONBLOCK);
+  struct stat s;
+  if (fd < 0 || fstat(fd, &s) != 0) {
+    if (fd >= 0) close(fd);
+    free(canonical);
+    return 1;
+  }
+
+  char* identity = malloc(48);
+  snprintf(identity, 48, "%ju:%ju", (uintmax_t) s.st_dev, (uintmax_t) s.st_ino);
+
+  String* path_key = new_string(canonical);
+  String* identity_key = new_string(identity);
+
+  if (table_find(&ws->loaded_files, path_key) || table_find(&ws->loaded_files, identity_key)) {
+    close(fd);
+    free(canonical);
+    free(identity);
+    free(path_key);
+    free(identity_key);
+    return 0;
+  }
+
+  table_add(&ws->loaded_files, path_key, file);
+  table_add(&ws->loaded_files, identity_key, file);
+
+  if (S_ISREG(s.st_mode)) file_prefetch(fd);
+  close(fd);
+  return 1;
+}
+
 void pipeline_emit_read_job(CompilationWorkspace* ws, String* filename) {
-  FileInfo* file = malloc(sizeof(FileInfo));
+  FileInfo* file = calloc(1, sizeof(FileInfo));
   file->filename = filename;
 
-  // @Lazy We should use a pool allocator.
-  Job* job = malloc(sizeof(Job));
-  job->type = JOB_READ;
-  job->ws = ws;
-  job->file = file;
+  if (!_pipeline_claim_file(ws, file)) {
+    free(file);
+    return;
+  }
+
+  // Read and lex the file in the background; the read and lex jobs below will
+  // pick up the results when the pipeline reaches them, in the usual order.
+  if (ws->scheduler) {
+    file->pending += 1;
+    scheduler_submit(ws->scheduler, perform_prefetch_task, file, &file->pending);
+  }
+
+  Job* job = pipeline_new_job(ws, JOB_READ, file);
 
   pipeline_emit(ws, job);
 }
 
 void pipeline_emit_lex_job(CompilationWorkspace* ws, FileInfo* file) {
-  // @Lazy We should use a pool allocator.
-  Job* job = malloc(sizeof(Job));
-  job->type = JOB_LEX;
-  job->ws = ws;
-  job->file = file;
+  Job* job = pipeline_new_job(ws, JOB_LEX, file);
 
   pipeline_emit(ws, job);
 }
 
 void pipeline_emit_parse_job(CompilationWorkspace* ws, FileInfo* file, TokenizedFile* tokens) {
-  // @Lazy We should use a pool allocator.
-  Job* job = malloc(sizeof(Job));
-  job->type = JOB_PARSE;
-  job->ws = ws;
-  job->file = file;
+  Job* job = pipeline_new_job(ws, JOB_PARSE, file);
   job->tokens = tokens;
 
   pipeline_emit(ws, job);
 }
 
 void pipeline_emit_typecheck_job(CompilationWorkspace* ws, FileInfo* file, AstNode* node) {
-  // @Lazy We should use a pool allocator.
-  Job* job = malloc(sizeof(Job));
-  job->type = JOB_TYPECHECK;
-  job->ws = ws;
-  job->file = file;
+  Job* job = pipeline_new_job(ws, JOB_TYPECHECK, file);
   job->node = node;
 
   pipeline_emit(ws, job);
 }
 
 void pipeline_emit_optimize_job(CompilationWorkspace* ws, FileInfo* file, AstNode* node) {
-  // @Lazy We should use a pool allocator.
-  Job* job = malloc(sizeof(Job));
-  job->type = JOB_OPTIMIZE;
-  job->ws = ws;
-  job->file = file;
+  Job* job = pipeline_new_job(ws, JOB_OPTIMIZE, file);
   job->node = node;
 
   pipeline_emit(ws, job);
 }
 
 void pipeline_emit_bytecode_job(CompilationWorkspace* ws, FileInfo* file, AstNode* node) {
-  // @Lazy We should use a pool allocator.
-  Job* job = malloc(sizeof(Job));
-  job->type = JOB_BYTECODE;
-  job->ws = ws;
-  job->file = file;
+  Job* job = pipeline_new_job(ws, JOB_BYTECODE, file);
   job->node = node;
 
   pipeline_emit(ws, job);
 }
 
 void pipeline_emit_execute_job(CompilationWorkspace* ws, VmState* state) {
-  // @Lazy We should use a pool allocator.
-  Job* job = malloc(sizeof(Job));
-  job->type = JOB_EXECUTE;
-  job->ws = ws;
+  Job* job = pipeline_new_job(ws, JOB_EXECUTE, NULL);
   job->vm_state = state;
 
   pipeline_emit(ws, job);
 }
 
 void pipeline_emit_abort_job(CompilationWorkspace* ws, FileInfo* file, AstNode* node) {
-  // @Lazy We should use a pool allocator.
-  Job* job = malloc(sizeof(Job));
-  job->type = JOB_ABORT;
-  job->ws = ws;
-  job->file = file;
+  Job* job = pipeline_new_job(ws, JOB_ABORT, file);
   job->node = node;
 
   pipeline_emit(ws, job);
@@ -1,55 +1,103 @@
 typedef struct {
-  List list;
-  // size_t capacity;
-  // size_t bucket_size;
-  // size_t size;
-  //
-  // void*** buckets;
-
-  size_t position;
+  size_t capacity;  // Always a power of two.
+  size_t head;
+  size_t length;
+
+  void** items;
 } Queue;
 
 
-void initialize_queue(Queue* queue, size_t bucket_count, size_t bucket_size) {
-  initialize_list((List*) queue, bucket_count, bucket_size);
-  queue->position = 0;
+size_t _queue_round_capacity(size_t capacity) {
+  size_t rounded = 1;
+  while (rounded < capacity) rounded <<= 1;
+  return rounded;
+}
+
+void initialize_queue(Queue* queue, size_t capacity) {
+  queue->capacity = _queue_round_capacity(capacity);
+  queue->head = 0;
+  queue->length = 0;
+  queue->items = malloc(queue->capacity * sizeof(void*));
 }
 
-Queue* new_queue(size_t bucket_count, size_t bucket_size) {
-  assert(bucket_count > 0);
-  assert(bucket_size > 0);
+Queue* new_queue(size_t capacity) {
+  assert(capacity > 0);
 
   Queue* ret = malloc(sizeof(Queue));
-  initialize_queue(ret, bucket_count, bucket_size);
+  initialize_queue(ret, capacity);
   return ret;
 }
 
 size_t queue_length(Queue* queue) {
-  return queue->list.length - queue->position;
+  return queue->length;
+}
+
+// Grows the queue to fit at least `required` items, unwrapping its contents to
+// the front of the new buffer.
+void _queue_reserve(Queue* queue, size_t required) {
+  if (required <= queue->capacity) return;
+
+  size_t capacity = _queue_round_capacity(required);
+  void** items = malloc(capacity * sizeof(void*));
+
+  size_t first = queue->capacity - queue->head;
+  if (first > queue->length) first = queue->length;
+
+  memcpy(items, queue->items + queue->head, first * sizeof(void*));
+  memcpy(items + first, queue->items, (queue->length - first) * sizeof(void*));
+
+  free(queue->items);
+  queue->items = items;
+  queue->capacity = capacity;
+  queue->head = 0;
 }
 
 void queue_add(Queue* queue, void* value) {
-  list_append((List*) queue, value);
+  _queue_reserve(queue, queue->length + 1);
+
+  queue->items[(queue->head + queue->length) & (queue->capacity - 1)] = value;
+  queue->length += 1;
+}
+
+void queue_add_n(Queue* queue, void** values, size_t count) {
+  _queue_reserve(queue, queue->length + count);
+
+  size_t tail = (queue->head + queue->length) & (queue->capacity - 1);
+  size_t first = queue->capacity - tail;
+  if (first > count) first = count;
+
+  memcpy(queue->items + tail, values, first * sizeof(void*));
+  memcpy(queue->items, values + first, (count - first) * sizeof(void*));
+  queue->length += count;
 }
 
 void* queue_pull(Queue* queue) {
-  void* ptr = list_get((List*) queue, queue->position);
-  queue->position += 1;
-
-  // If we've emptied a bucket we should rotate them, so that we can avoid
-  // unnecessary allocations.
-  // @TODO There may be a better way of handling this.
-  if (queue->position == queue->list.bucket_size) {
-    queue->position = 0;
-    queue->list.length -= queue->list.bucket_size;
-    void** empty = queue->list.buckets[0];
-
-    size_t bucket_count = queue->list.capacity / queue->list.bucket_size;
-    for (int i = 0; i < bucket_count - 1; i++) {
-      queue->list.buckets[i] = queue->list.buckets[i + 1];
-    }
-    queue->list.buckets[bucket_count - 1] = empty;
-  }
+  assert(queue->length > 0);
+
+  void* ptr = queue->items[queue->head];
+  queue->head = (queue->head + 1) & (queue->capacity - 1);
+  queue->length -= 1;
 
   return ptr;
 }
+
+// Pulls up to `count` items into `values`, returning the number pulled.
+size_t queue_pull_n(Queue* queue, void** values, size_t count) {
+  if (count > queue->length) count = queue->length;
+
+  size_t first = queue->capacity - queue->head;
+  if (first > count) first = count;
+
+  memcpy(values, queue->items + queue->head, first * sizeof(void*));
+  memcpy(values + first, queue->items, (count - first) * sizeof(void*));
+
+  queue->head = (queue->head + count) & (queue->capacity - 1);
+  queue->length -= count;
+
+  return count;
+}
+
+void free_queue(Queue* queue) {
+  free(queue->items);
+  free(queue);
+}
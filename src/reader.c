@@ -1,16 +1,28 @@
-bool perform_read_job(Job* job) {
-  FileInfo* file = job->file;
-
+void read_file(FileInfo* file) {
   // @Lazy `filename.data` may not be naturally zero-terminated.
   char* filename = to_zero_terminated_string(file->filename);
   file->source = file_read_all(filename);
   free(filename);
 
+  if (file->source != NULL) __stats.bytes_read += file->source->length;
+}
+
+bool perform_read_job(Job* job) {
+  FileInfo* file = job->file;
+
+  if (job->ws->scheduler) scheduler_wait(job->ws->scheduler, &file->pending);
+  if (file->source == NULL) read_file(file);
+
   if (file->source == NULL) {
     // @TODO: Record an error about not being able to find this file.
     return 0;
   }
 
+  // Files with identical contents (like a helper copied into several modules)
+  // are only processed once.
+  if (table_find(&job->ws->loaded_sources, file->source)) return 1;
+  table_add(&job->ws->loaded_sources, file->source, file);
+
   pipeline_emit_lex_job(job->ws, file);
   return 1;
 }
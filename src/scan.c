@@ -0,0 +1,229 @@
+// Vectorized scanning loops for the lexer's hottest character classes.
+//
+// Each scanner returns the position of the first byte at or after `pos` which
+// doesn't belong to its class (or `length`, if they all do).  The SSE2 and AVX2
+// versions consume a whole vector at a time, and hand the last partial vector
+// to the scalar version; they never read past `length`, since the source may
+// be mapped right up to the end of a page.
+
+typedef size_t (*ScanFunction)(const char* data, size_t pos, size_t length);
+
+typedef struct {
+  ScanFunction whitespace;  // Spaces, tabs and carriage returns.
+  ScanFunction identifier;  // [0-9A-Za-z_]; the lexer handles any stragglers.
+  ScanFunction string;      // Anything but a closing quote or a newline.
+  ScanFunction line;        // Anything but a newline.
+  ScanFunction ascii;       // Anything below 0x80.
+} Scanners;
+
+
+// ** Scalar ** //
+
+size_t scan_whitespace_scalar(const char* data, size_t pos, size_t length) {
+  while (pos < length && (data[pos] == ' ' || data[pos] == '\t' || data[pos] == '\r')) pos++;
+  return pos;
+}
+
+size_t scan_identifier_scalar(const char* data, size_t pos, size_t length) {
+  while (pos < length) {
+    char c = data[pos];
+    if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_')) break;
+    pos++;
+  }
+  return pos;
+}
+
+size_t scan_string_scalar(const char* data, size_t pos, size_t length) {
+  while (pos < length && data[pos] != '"' && data[pos] != '\n') pos++;
+  return pos;
+}
+
+size_t scan_line_scalar(const char* data, size_t pos, size_t length) {
+  while (pos < length && data[pos] != '\n') pos++;
+  return pos;
+}
+
+size_t scan_ascii_scalar(const char* data, size_t pos, size_t length) {
+  while (pos < length && (unsigned char) data[pos] < 0x80) pos++;
+  return pos;
+}
+
+static const Scanners ScalarScanners = {
+  scan_whitespace_scalar,
+  scan_identifier_scalar,
+  scan_string_scalar,
+  scan_line_scalar,
+  scan_ascii_scalar,
+};
+
+#if defined(__x86_64__)
+
+// STOPS computes a bitmask (from the vector `v`) of the bytes which end the
+// scan; the first of those is where we stop.
+#define SCAN_VECTOR_LOOP(WIDTH, LOAD, STOPS, SCALAR)                           \
+  while (pos + WIDTH <= length) {                                              \
+    VECTOR v = LOAD((const VECTOR*) (data + pos));                             \
+    uint32_t stops = STOPS;                                                    \
+    if (stops) return pos + __builtin_ctz(stops);                              \
+    pos += WIDTH;                                                              \
+  }                                                                            \
+  return SCALAR(data, pos, length);
+
+
+// ** SSE2 ** //
+
+#define VECTOR  __m128i
+
+size_t scan_whitespace_sse2(const char* data, size_t pos, size_t length) {
+  const VECTOR space = _mm_set1_epi8(' ');
+  const VECTOR tab = _mm_set1_epi8('\t');
+  const VECTOR carriage_return = _mm_set1_epi8('\r');
+  SCAN_VECTOR_LOOP(16, _mm_loadu_si128,
+                   ~_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)), _mm_cmpeq_epi8(v, carriage_return))) & 0xFFFF,
+                   scan_whitespace_scalar);
+}
+
+size_t scan_identifier_sse2(const char* data, size_t pos, size_t length) {
+  // Bytes above 0x7f compare as negative, so they fall outside every range.
+  const VECTOR digit_lo = _mm_set1_epi8('0' - 1);
+  const VECTOR digit_hi = _mm_set1_epi8('9' + 1);
+  const VECTOR alpha_lo = _mm_set1_epi8('a' - 1);
+  const VECTOR alpha_hi = _mm_set1_epi8('z' + 1);
+  const VECTOR fold = _mm_set1_epi8(0x20);
+  const VECTOR underscore = _mm_set1_epi8('_');
+
+  while (pos + 16 <= length) {
+    VECTOR v = _mm_loadu_si128((const VECTOR*) (data + pos));
+    VECTOR lower = _mm_or_si128(v, fold);
+
+    VECTOR digit = _mm_and_si128(_mm_cmpgt_epi8(v, digit_lo), _mm_cmplt_epi8(v, digit_hi));
+    VECTOR alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, alpha_lo), _mm_cmplt_epi8(lower, alpha_hi));
+    VECTOR ident = _mm_or_si128(_mm_or_si128(digit, alpha), _mm_cmpeq_epi8(v, underscore));
+
+    uint32_t stops = (uint32_t) ~_mm_movemask_epi8(ident) & 0xFFFF;
+    if (stops) return pos + __builtin_ctz(stops);
+    pos += 16;
+  }
+
+  return scan_identifier_scalar(data, pos, length);
+}
+
+size_t scan_string_sse2(const char* data, size_t pos, size_t length) {
+  const VECTOR quote = _mm_set1_epi8('"');
+  const VECTOR newline = _mm_set1_epi8('\n');
+  SCAN_VECTOR_LOOP(16, _mm_loadu_si128,
+                   _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, newline))),
+                   scan_string_scalar);
+}
+
+size_t scan_line_sse2(const char* data, size_t pos, size_t length) {
+  const VECTOR newline = _mm_set1_epi8('\n');
+  SCAN_VECTOR_LOOP(16, _mm_loadu_si128,
+                   _mm_movemask_epi8(_mm_cmpeq_epi8(v, newline)),
+                   scan_line_scalar);
+}
+
+size_t scan_ascii_sse2(const char* data, size_t pos, size_t length) {
+  SCAN_VECTOR_LOOP(16, _mm_loadu_si128,
+                   _mm_movemask_epi8(v),
+                   scan_ascii_scalar);
+}
+
+static const Scanners SSE2Scanners = {
+  scan_whitespace_sse2,
+  scan_identifier_sse2,
+  scan_string_sse2,
+  scan_line_sse2,
+  scan_ascii_sse2,
+};
+
+#undef VECTOR
+
+
+// ** AVX2 ** //
+
+#define VECTOR  __m256i
+
+__attribute__((target("avx2")))
+size_t scan_whitespace_avx2(const char* data, size_t pos, size_t length) {
+  const VECTOR space = _mm256_set1_epi8(' ');
+  const VECTOR tab = _mm256_set1_epi8('\t');
+  const VECTOR carriage_return = _mm256_set1_epi8('\r');
+  SCAN_VECTOR_LOOP(32, _mm256_loadu_si256,
+                   ~(uint32_t) _mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab)), _mm256_cmpeq_epi8(v, carriage_return))),
+                   scan_whitespace_sse2);
+}
+
+__attribute__((target("avx2")))
+size_t scan_identifier_avx2(const char* data, size_t pos, size_t length) {
+  const VECTOR digit_lo = _mm256_set1_epi8('0' - 1);
+  const VECTOR digit_hi = _mm256_set1_epi8('9' + 1);
+  const VECTOR alpha_lo = _mm256_set1_epi8('a' - 1);
+  const VECTOR alpha_hi = _mm256_set1_epi8('z' + 1);
+  const VECTOR fold = _mm256_set1_epi8(0x20);
+  const VECTOR underscore = _mm256_set1_epi8('_');
+
+  while (pos + 32 <= length) {
+    VECTOR v = _mm256_loadu_si256((const VECTOR*) (data + pos));
+    VECTOR lower = _mm256_or_si256(v, fold);
+
+    VECTOR digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, digit_lo), _mm256_cmpgt_epi8(digit_hi, v));
+    VECTOR alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, alpha_lo), _mm256_cmpgt_epi8(alpha_hi, lower));
+    VECTOR ident = _mm256_or_si256(_mm256_or_si256(digit, alpha), _mm256_cmpeq_epi8(v, underscore));
+
+    uint32_t stops = ~(uint32_t) _mm256_movemask_epi8(ident);
+    if (stops) return pos + __builtin_ctz(stops);
+    pos += 32;
+  }
+
+  return scan_identifier_sse2(data, pos, length);
+}
+
+__attribute__((target("avx2")))
+size_t scan_string_avx2(const char* data, size_t pos, size_t length) {
+  const VECTOR quote = _mm256_set1_epi8('"');
+  const VECTOR newline = _mm256_set1_epi8('\n');
+  SCAN_VECTOR_LOOP(32, _mm256_loadu_si256,
+                   (uint32_t) _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, newline))),
+                   scan_string_sse2);
+}
+
+__attribute__((target("avx2")))
+size_t scan_line_avx2(const char* data, size_t pos, size_t length) {
+  const VECTOR newline = _mm256_set1_epi8('\n');
+  SCAN_VECTOR_LOOP(32, _mm256_loadu_si256,
+                   (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, newline)),
+                   scan_line_sse2);
+}
+
+__attribute__((target("avx2")))
+size_t scan_ascii_avx2(const char* data, size_t pos, size_t length) {
+  SCAN_VECTOR_LOOP(32, _mm256_loadu_si256,
+                   (uint32_t) _mm256_movemask_epi8(v),
+                   scan_ascii_sse2);
+}
+
+static const Scanners AVX2Scanners = {
+  scan_whitespace_avx2,
+  scan_identifier_avx2,
+  scan_string_avx2,
+  scan_line_avx2,
+  scan_ascii_avx2,
+};
+
+#undef VECTOR
+
+#endif  // __x86_64__
+
+#undef SCAN_VECTOR_LOOP
+
+
+// Picks the widest implementation the running CPU supports.
+const Scanners* select_scanners() {
+#if defined(__x86_64__)
+  if (__builtin_cpu_supports("avx2")) return &AVX2Scanners;
+  return &SSE2Scanners;  // Always available on x86-64.
+#else
+  return &ScalarScanners;
+#endif
+}
@@ -0,0 +1,167 @@
+// A pool of worker threads for pipeline work that can safely run off the main
+// thread (presently, reading and lexing source files).  Each worker owns a
+// lock-free queue of tasks; tasks are dealt out round-robin, and a worker whose
+// queue runs dry will steal from its peers.
+
+typedef struct {
+  void (*perform)(void* data);
+  void* data;
+  size_t* pending;  // Decremented once the task has completed.
+} Task;
+
+typedef struct Scheduler {
+  size_t worker_count;
+  pthread_t* threads;
+  AtomicQueue* deques;
+
+  pthread_mutex_t lock;
+  pthread_cond_t work_available;
+  pthread_cond_t work_completed;
+
+  _Atomic size_t queued;      // Tasks sitting in any deque.
+  _Atomic size_t next_deque;  // Round-robin cursor for new submissions.
+  char shutting_down;
+} Scheduler;
+
+typedef struct {
+  Scheduler* scheduler;
+  size_t index;
+} WorkerInfo;
+
+
+int scheduler_take(Scheduler* s, size_t index, Task* task) {
+  Task* found = NULL;
+
+  for (size_t i = 0; found == NULL && i < s->worker_count; i++) {
+    atomic_queue_pull(&s->deques[(index + i) % s->worker_count], (void**) &found);
+  }
+
+  if (found == NULL) return 0;
+
+  atomic_fetch_sub(&s->queued, 1);
+  *task = *found;
+  free(found);
+  return 1;
+}
+
+void scheduler_run(Scheduler* s, Task task) {
+  task.perform(task.data);
+
+  pthread_mutex_lock(&s->lock);
+  *task.pending -= 1;
+  pthread_cond_broadcast(&s->work_completed);
+  pthread_mutex_unlock(&s->lock);
+}
+
+void* _scheduler_worker(void* data) {
+  WorkerInfo* info = data;
+  Scheduler* s = info->scheduler;
+
+  while (1) {
+    Task task;
+    if (scheduler_take(s, info->index, &task)) {
+      scheduler_run(s, task);
+      continue;
+    }
+
+    pthread_mutex_lock(&s->lock);
+    while (s->queued == 0 && !s->shutting_down) {
+      pthread_cond_wait(&s->work_available, &s->lock);
+    }
+    char done = s->queued == 0 && s->shutting_down;
+    pthread_mutex_unlock(&s->lock);
+
+    if (done) break;
+  }
+
+  free(info);
+  return NULL;
+}
+
+Scheduler* new_scheduler(size_t worker_count) {
+  assert(worker_count > 0);
+
+  Scheduler* s = calloc(1, sizeof(Scheduler));
+  s->worker_count = worker_count;
+  s->threads = malloc(worker_count * sizeof(pthread_t));
+  s->deques = aligned_alloc(_Alignof(AtomicQueue), worker_count * sizeof(AtomicQueue));
+
+  pthread_mutex_init(&s->lock, NULL);
+  pthread_cond_init(&s->work_available, NULL);
+  pthread_cond_init(&s->work_completed, NULL);
+
+  for (size_t i = 0; i < worker_count; i++) {
+    initialize_atomic_queue(&s->deques[i], 256);
+  }
+
+  for (size_t i = 0; i < worker_count; i++) {
+    WorkerInfo* info = malloc(sizeof(WorkerInfo));
+    info->scheduler = s;
+    info->index = i;
+    pthread_create(&s->threads[i], NULL, _scheduler_worker, info);
+  }
+
+  return s;
+}
+
+// @Precondition `*pending` has already been incremented by the caller.
+void scheduler_submit(Scheduler* s, void (*perform)(void*), void* data, size_t* pending) {
+  Task* task = malloc(sizeof(Task));
+  *task = (Task) { perform, data, pending };
+
+  // If every deque is full, we'll just do the work ourselves.
+  size_t index = atomic_fetch_add(&s->next_deque, 1);
+  for (size_t i = 0; i < s->worker_count; i++) {
+    if (atomic_queue_add(&s->deques[(index + i) % s->worker_count], task)) {
+      atomic_fetch_add(&s->queued, 1);
+
+      pthread_mutex_lock(&s->lock);
+      pthread_cond_signal(&s->work_available);
+      pthread_mutex_unlock(&s->lock);
+      return;
+    }
+  }
+
+  free(task);
+  scheduler_run(s, (Task) { perform, data, pending });
+}
+
+// Blocks until `*pending` reaches zero.  Rather than idling, the waiting thread
+// helps out by running any queued tasks itself.
+void scheduler_wait(Scheduler* s, size_t* pending) {
+  while (1) {
+    pthread_mutex_lock(&s->lock);
+    size_t remaining = *pending;
+    pthread_mutex_unlock(&s->lock);
+
+    if (remaining == 0) return;
+
+    Task task;
+    if (scheduler_take(s, 0, &task)) {
+      scheduler_run(s, task);
+      continue;
+    }
+
+    pthread_mutex_lock(&s->lock);
+    while (*pending > 0 && s->queued == 0) {
+      pthread_cond_wait(&s->work_completed, &s->lock);
+    }
+    pthread_mutex_unlock(&s->lock);
+  }
+}
+
+void free_scheduler(Scheduler* s) {
+  pthread_mutex_lock(&s->lock);
+  s->shutting_down = 1;
+  pthread_cond_broadcast(&s->work_available);
+  pthread_mutex_unlock(&s->lock);
+
+  for (size_t i = 0; i < s->worker_count; i++) {
+    pthread_join(s->threads[i], NULL);
+    free(s->deques[i].cells);
+  }
+
+  free(s->threads);
+  free(s->deques);
+  free(s);
+}
@@ -0,0 +1,136 @@
+// Counters and timings for each stage of the pipeline, reported by `--stats`.
+//
+// The counters may be bumped from scheduler threads, so they're atomic; the
+// per-stage timings are only ever recorded on the main thread, which is also
+// the only thread running pipeline jobs.
+
+typedef enum {
+  STATS_NONE,
+  STATS_TABLE,
+  STATS_JSON,
+} StatsFormat;
+
+typedef struct {
+  double wall;
+  double cpu;
+} StatsTimestamp;
+
+typedef struct {
+  size_t runs;
+  size_t retries;  // Runs of jobs which had previously been parked.
+  StatsTimestamp elapsed;
+} StageStats;
+
+typedef struct {
+  StatsFormat format;  // Jobs are only timed if their timings will be reported.
+  StageStats stages[JOB_ABORT + 1];
+  StatsTimestamp elapsed;  // CPU time here covers every thread.
+
+  _Atomic size_t bytes_read;
+  _Atomic size_t tokens;
+  _Atomic size_t ast_nodes;
+  _Atomic size_t arena_bytes;
+  _Atomic size_t bytecode_words;
+  _Atomic size_t instructions_retired;
+} CompilationStats;
+
+CompilationStats __stats = {};
+
+static char* StageNames[JOB_ABORT + 1] = {
+  "read",
+  "lex",
+  "parse",
+  "typecheck",
+  "optimize",
+  "bytecode",
+  "execute",
+  "abort",
+};
+
+
+double _stats_clock(clockid_t clock) {
+  struct timespec t;
+  clock_gettime(clock, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+// CPU time is measured for the calling thread.
+StatsTimestamp stats_now() {
+  return (StatsTimestamp) { _stats_clock(CLOCK_MONOTONIC), _stats_clock(CLOCK_THREAD_CPUTIME_ID) };
+}
+
+void stats_record_job(Job* job, StatsTimestamp started) {
+  StageStats* stage = &__stats.stages[job->type];
+
+  stage->runs += 1;
+  if (job->attempts > 0) stage->retries += 1;
+
+  if (__stats.format != STATS_NONE) {
+    StatsTimestamp now = stats_now();
+    stage->elapsed.wall += now.wall - started.wall;
+    stage->elapsed.cpu += now.cpu - started.cpu;
+  }
+
+  job->attempts += 1;
+}
+
+// Moves the instructions an execute job has retired since it was last recorded
+// into the totals; called each time the job returns, whether or not it's done.
+void stats_record_execution(VmState* state) {
+  __stats.instructions_retired += state->retired;
+  state->retired = 0;
+}
+
+void stats_begin_compilation() {
+  __stats.elapsed = (StatsTimestamp) { _stats_clock(CLOCK_MONOTONIC), _stats_clock(CLOCK_PROCESS_CPUTIME_ID) };
+}
+
+void stats_end_compilation() {
+  __stats.elapsed.wall = _stats_clock(CLOCK_MONOTONIC) - __stats.elapsed.wall;
+  __stats.elapsed.cpu = _stats_clock(CLOCK_PROCESS_CPUTIME_ID) - __stats.elapsed.cpu;
+}
+
+
+// ** Reporting ** //
+
+void _print_stats_table(FILE* out) {
+  fprintf(out, "\n%-12s %10s %10s %12s %12s\n", "Stage", "Runs", "Retries", "Wall (ms)", "CPU (ms)");
+
+  for (size_t i = 0; i <= JOB_ABORT; i++) {
+    StageStats* stage = &__stats.stages[i];
+    fprintf(out, "%-12s %10zu %10zu %12.3f %12.3f\n", StageNames[i], stage->runs, stage->retries, stage->elapsed.wall * 1e3, stage->elapsed.cpu * 1e3);
+  }
+
+  fprintf(out, "%-12s %10s %10s %12.3f %12.3f\n", "total", "", "", __stats.elapsed.wall * 1e3, __stats.elapsed.cpu * 1e3);
+
+  fprintf(out, "\n");
+  fprintf(out, "%-24s %12zu\n", "Bytes read", (size_t) __stats.bytes_read);
+  fprintf(out, "%-24s %12zu\n", "Tokens", (size_t) __stats.tokens);
+  fprintf(out, "%-24s %12zu\n", "AST nodes", (size_t) __stats.ast_nodes);
+  fprintf(out, "%-24s %12zu\n", "Arena bytes", (size_t) __stats.arena_bytes);
+  fprintf(out, "%-24s %12zu\n", "Bytecode words", (size_t) __stats.bytecode_words);
+  fprintf(out, "%-24s %12zu\n", "Instructions retired", (size_t) __stats.instructions_retired);
+}
+
+void _print_stats_json(FILE* out) {
+  fprintf(out, "{\"stages\": {");
+
+  for (size_t i = 0; i <= JOB_ABORT; i++) {
+    StageStats* stage = &__stats.stages[i];
+    fprintf(out, "%s\"%s\": {\"runs\": %zu, \"retries\": %zu, \"wall_ms\": %.3f, \"cpu_ms\": %.3f}",
+            i > 0 ? ", " : "", StageNames[i], stage->runs, stage->retries, stage->elapsed.wall * 1e3, stage->elapsed.cpu * 1e3);
+  }
+
+  fprintf(out, "}, \"wall_ms\": %.3f, \"cpu_ms\": %.3f", __stats.elapsed.wall * 1e3, __stats.elapsed.cpu * 1e3);
+  fprintf(out, ", \"bytes_read\": %zu", (size_t) __stats.bytes_read);
+  fprintf(out, ", \"tokens\": %zu", (size_t) __stats.tokens);
+  fprintf(out, ", \"ast_nodes\": %zu", (size_t) __stats.ast_nodes);
+  fprintf(out, ", \"arena_bytes\": %zu", (size_t) __stats.arena_bytes);
+  fprintf(out, ", \"bytecode_words\": %zu", (size_t) __stats.bytecode_words);
+  fprintf(out, ", \"instructions_retired\": %zu}\n", (size_t) __stats.instructions_retired);
+}
+
+void print_stats(FILE* out, StatsFormat format) {
+  if (format == STATS_TABLE) _print_stats_table(out);
+  if (format == STATS_JSON) _print_stats_json(out);
+}
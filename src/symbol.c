@@ -1,32 +1,115 @@
-typedef size_t Symbol;
+// Symbols are kept in 32 bits, as they are in the token stream and the AST.
+typedef uint32_t Symbol;
 
+// The language's own keywords, directives and operators are interned first, in
+// this order, so their Symbols are known constants and tokens can be matched
+// against them by id.
+typedef enum {
+  SYMBOL_NONE,
+
+  KEYWORD_RETURN,
+  KEYWORD_IF,
+  KEYWORD_LOOP,
+  KEYWORD_BREAK,
+
+  DIRECTIVE_LOAD,
+  DIRECTIVE_CHAR,
+
+  OP_DECLARE,
+  OP_DECLARE_ASSIGN,
+  OP_ASSIGN,
+  OP_FUNC_ARROW,
+  OP_OPEN_PAREN,
+  OP_CLOSE_PAREN,
+  OP_OPEN_BRACE,
+  OP_CLOSE_BRACE,
+  OP_COMMA,
+  OP_NEWLINE,
+
+  SEEDED_SYMBOL_COUNT,
+} SeededSymbol;
+
+static char* SEEDED_SYMBOLS[SEEDED_SYMBOL_COUNT] = {
+  [KEYWORD_RETURN]    = "return",
+  [KEYWORD_IF]        = "if",
+  [KEYWORD_LOOP]      = "loop",
+  [KEYWORD_BREAK]     = "break",
+
+  [DIRECTIVE_LOAD]    = "@load",
+  [DIRECTIVE_CHAR]    = "@char",
+
+  [OP_DECLARE]        = ":",
+  [OP_DECLARE_ASSIGN] = ":=",
+  [OP_ASSIGN]         = "=",
+  [OP_FUNC_ARROW]     = "=>",
+  [OP_OPEN_PAREN]     = "(",
+  [OP_CLOSE_PAREN]    = ")",
+  [OP_OPEN_BRACE]     = "{",
+  [OP_CLOSE_BRACE]    = "}",
+  [OP_COMMA]          = ",",
+  [OP_NEWLINE]        = "\n",
+};
+
+#define IS_KEYWORD_SYMBOL(S)  ((S) >= KEYWORD_RETURN && (S) <= KEYWORD_BREAK)
+
+// Identifiers are interned by the lexer, which may be running on any thread;
+// lookups share the lock, and only new symbols take it exclusively.
 Table* __symbol_table = NULL;
 List* __symbol_lookup = NULL;
+pthread_rwlock_t __symbol_lock = PTHREAD_RWLOCK_INITIALIZER;
+pthread_once_t __symbol_once = PTHREAD_ONCE_INIT;
+
+Symbol _symbol_insert(String* text) {
+  String* copy = malloc(sizeof(String));
+  memcpy(copy, text, sizeof(String));
+
+  // Tables only grow once they're completely full, and the probing gets slow
+  // well before then; since every identifier is interned, keep this one sparse.
+  if (__symbol_table->size * 2 >= __symbol_table->capacity) {
+    table_resize(__symbol_table, __symbol_table->capacity * 2);
+  }
+
+  Symbol id = list_append(__symbol_lookup, copy) + 1;
+  table_add(__symbol_table, copy, (void*) (uintptr_t) id);
+  return id;
+}
 
 void _initialize_symbol_data() {
   __symbol_table = new_table(256);
   __symbol_lookup = new_list(8, 32);
+
+  for (size_t i = 1; i < SEEDED_SYMBOL_COUNT; i++) {
+    Symbol id = _symbol_insert(new_string(SEEDED_SYMBOLS[i]));
+    assert(id == i);
+  }
 }
 
 Symbol symbol_get(String* text) {
-  // @TODO Eagerly initialize these.
-  if (__symbol_table == NULL) _initialize_symbol_data();
+  pthread_once(&__symbol_once, _initialize_symbol_data);
+
+  pthread_rwlock_rdlock(&__symbol_lock);
+  Symbol id = (uintptr_t) table_find(__symbol_table, text);
+  pthread_rwlock_unlock(&__symbol_lock);
 
-  Symbol id = (Symbol) table_find(__symbol_table, text);
-  if ((void*) id == NULL) {
-    String* copy = malloc(sizeof(String));
-    memcpy(copy, text, sizeof(String));
+  if (id == SYMBOL_NONE) {
+    pthread_rwlock_wrlock(&__symbol_lock);
 
-    id = list_append(__symbol_lookup, copy) + 1;
-    table_add(__symbol_table, copy, (void*) id);
+    // Someone else may have beaten us to it.
+    id = (uintptr_t) table_find(__symbol_table, text);
+    if (id == SYMBOL_NONE) id = _symbol_insert(text);
+
+    pthread_rwlock_unlock(&__symbol_lock);
   }
 
   return id;
 }
 
 String* symbol_lookup(Symbol id) {
-  // @TODO Eagerly initialize these.
-  if (__symbol_table == NULL) _initialize_symbol_data();
+  pthread_once(&__symbol_once, _initialize_symbol_data);
+
+  pthread_rwlock_rdlock(&__symbol_lock);
+  String* text = list_get(__symbol_lookup, id - 1);
+  pthread_rwlock_unlock(&__symbol_lock);
 
-  return list_get(__symbol_lookup, id - 1);
+  return text;
 }
@@ -134,3 +134,87 @@ void free_table(Table* t) {
   free(t->values);
   free(t);
 }
+
+
+// ** Id Tables ** //
+
+// Maps serial numbers to values.  These hold data which only a few objects
+// carry, kept to one side rather than in a field of every object; there's no
+// removal, so clearing an entry stores NULL against its id.
+
+typedef struct {
+  size_t capacity;  // Always a power of two.
+  size_t size;
+
+  char* occupied;
+  uint32_t* keys;
+  void** values;
+} IdTable;
+
+void initialize_id_table(IdTable* table, size_t capacity) {
+  assert(capacity != 0 && (capacity & (capacity - 1)) == 0);
+
+  table->capacity = capacity;
+  table->size = 0;
+  table->occupied = calloc(capacity, sizeof(char));
+  table->keys = malloc(capacity * sizeof(uint32_t));
+  table->values = malloc(capacity * sizeof(void*));
+}
+
+size_t _id_table_find_slot(IdTable* table, uint32_t key) {
+  size_t slot = key * 2654435761u;
+
+  while (1) {
+    slot &= table->capacity - 1;
+    if (!table->occupied[slot] || table->keys[slot] == key) return slot;
+    slot += 1;
+  }
+}
+
+void _id_table_resize(IdTable* table, size_t capacity) {
+  IdTable tmp;
+  initialize_id_table(&tmp, capacity);
+
+  for (size_t i = 0; i < table->capacity; i++) {
+    if (!table->occupied[i]) continue;
+
+    size_t slot = _id_table_find_slot(&tmp, table->keys[i]);
+    tmp.occupied[slot] = 1;
+    tmp.keys[slot] = table->keys[i];
+    tmp.values[slot] = table->values[i];
+  }
+
+  free(table->occupied);
+  free(table->keys);
+  free(table->values);
+
+  tmp.size = table->size;
+  *table = tmp;
+}
+
+void id_table_add(IdTable* table, uint32_t key, void* value) {
+  // Kept at most half full, so that probes stay short.
+  if (2 * (table->size + 1) > table->capacity) _id_table_resize(table, table->capacity * 2);
+
+  size_t slot = _id_table_find_slot(table, key);
+  if (!table->occupied[slot]) table->size += 1;
+
+  table->occupied[slot] = 1;
+  table->keys[slot] = key;
+  table->values[slot] = value;
+}
+
+void* id_table_find(IdTable* table, uint32_t key) {
+  if (table->size == 0) return NULL;
+
+  size_t slot = _id_table_find_slot(table, key);
+  if (!table->occupied[slot]) return NULL;
+
+  return table->values[slot];
+}
+
+void free_id_table(IdTable* table) {
+  free(table->occupied);
+  free(table->keys);
+  free(table->values);
+}
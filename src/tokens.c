@@ -0,0 +1,222 @@
+// The token stream is stored column-wise: one small array per field, indexed
+// by token number, so that the parser's peeking (which only ever looks at the
+// type and symbol) touches a few bytes per token rather than a whole struct.
+// Source text and positions are recovered from offsets on demand.
+//
+// Large files are lexed as a stream of windows, so a TokenizedFile may only
+// hold a run of the file's tokens: those numbered from `base` onwards.  Token
+// numbers are always counted from the start of the file, so they stay valid
+// while earlier tokens are discarded and later ones appended.
+
+#define TOKEN_LITERAL_SHIFT  8
+#define TOKEN_LITERAL_MASK   0x1F
+#define TOKEN_WIDTH_MASK     0x60
+#define TOKEN_WELL_FORMED    0x80
+
+
+// ** Construction ** //
+
+void initialize_tokenized_file(TokenizedFile* tokens, String* source) {
+  tokens->base = 0;
+  tokens->length = 0;
+  tokens->capacity = 0;
+  tokens->types = NULL;
+  tokens->flags = NULL;
+  tokens->offsets = NULL;
+  tokens->lengths = NULL;
+  tokens->symbols = NULL;
+  tokens->values = NULL;
+  tokens->value_tokens = NULL;
+  tokens->value_count = 0;
+  tokens->value_capacity = 0;
+  tokens->source = source;
+  tokens->invalid_utf8 = source->length;
+  tokens->stream = NULL;
+}
+
+void _tokenized_file_reserve(TokenizedFile* tokens, size_t capacity) {
+  tokens->capacity = capacity;
+  tokens->types = realloc(tokens->types, tokens->capacity * sizeof(unsigned char));
+  tokens->flags = realloc(tokens->flags, tokens->capacity * sizeof(unsigned char));
+  tokens->offsets = realloc(tokens->offsets, tokens->capacity * sizeof(uint32_t));
+  tokens->lengths = realloc(tokens->lengths, tokens->capacity * sizeof(uint32_t));
+  tokens->symbols = realloc(tokens->symbols, tokens->capacity * sizeof(uint32_t));
+}
+
+void tokenized_file_append(TokenizedFile* tokens, TokenType type, size_t offset, size_t length, TokenLiteralType literal_type, bool is_well_formed, Symbol symbol) {
+  if (tokens->length == tokens->capacity) _tokenized_file_reserve(tokens, tokens->capacity ? tokens->capacity * 2 : 128);
+
+  size_t i = tokens->length++;
+  tokens->types[i] = type;
+  tokens->flags[i] = (literal_type >> TOKEN_LITERAL_SHIFT) | (is_well_formed ? TOKEN_WELL_FORMED : 0);
+  tokens->offsets[i] = offset;
+  tokens->lengths[i] = length;
+  tokens->symbols[i] = symbol;
+}
+
+void _tokenized_file_reserve_values(TokenizedFile* tokens, size_t capacity) {
+  tokens->value_capacity = capacity;
+  tokens->values = realloc(tokens->values, tokens->value_capacity * sizeof(uint64_t));
+  tokens->value_tokens = realloc(tokens->value_tokens, tokens->value_capacity * sizeof(uint32_t));
+}
+
+// Integer literals carry their value and its width; a literal which doesn't fit
+// in 64 bits isn't well formed.  Most tokens don't have a value, so they're kept
+// to one side, along with the number of the token each belongs to.
+void tokenized_file_append_integer(TokenizedFile* tokens, size_t offset, size_t length, TokenLiteralType literal_type, uint64_t value, bool fits) {
+  if (tokens->value_count == tokens->value_capacity) _tokenized_file_reserve_values(tokens, tokens->value_capacity ? tokens->value_capacity * 2 : 32);
+
+  LiteralWidth width = value <= UINT8_MAX ? LITERAL_8_BITS :
+                       value <= UINT16_MAX ? LITERAL_16_BITS :
+                       value <= UINT32_MAX ? LITERAL_32_BITS : LITERAL_64_BITS;
+
+  size_t index = tokens->value_count++;
+  tokens->values[index] = value;
+  tokens->value_tokens[index] = tokens->base + tokens->length;
+  tokenized_file_append(tokens, TOKEN_LITERAL, offset, length, literal_type | width, fits, SYMBOL_NONE);
+}
+
+// The position in `values` of the first value belonging to token `i` or later.
+size_t _tokenized_file_find_value(TokenizedFile* tokens, size_t i) {
+  size_t low = 0;
+  size_t high = tokens->value_count;
+
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (tokens->value_tokens[mid] < i) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  return low;
+}
+
+// Appends all of `more`'s tokens, which must come from the same source.
+// Doubles `capacity` (or starts from `initial`) until it holds `needed` items,
+// so that repeated extends grow the columns geometrically, as appends do.
+size_t _tokenized_file_grown(size_t capacity, size_t needed, size_t initial) {
+  if (capacity == 0) capacity = initial;
+  while (capacity < needed) capacity *= 2;
+  return capacity;
+}
+
+void tokenized_file_extend(TokenizedFile* tokens, TokenizedFile* more) {
+  assert(tokens->source == more->source);
+
+  if (more->invalid_utf8 < tokens->invalid_utf8) tokens->invalid_utf8 = more->invalid_utf8;
+
+  size_t length = tokens->length + more->length;
+  if (length > tokens->capacity) _tokenized_file_reserve(tokens, _tokenized_file_grown(tokens->capacity, length, 128));
+
+  size_t i = tokens->length;
+  memcpy(tokens->types + i, more->types, more->length * sizeof(unsigned char));
+  memcpy(tokens->flags + i, more->flags, more->length * sizeof(unsigned char));
+  memcpy(tokens->offsets + i, more->offsets, more->length * sizeof(uint32_t));
+  memcpy(tokens->lengths + i, more->lengths, more->length * sizeof(uint32_t));
+  memcpy(tokens->symbols + i, more->symbols, more->length * sizeof(uint32_t));
+  tokens->length = length;
+
+  if (more->value_count == 0) return;
+
+  size_t count = tokens->value_count + more->value_count;
+  if (count > tokens->value_capacity) _tokenized_file_reserve_values(tokens, _tokenized_file_grown(tokens->value_capacity, count, 32));
+
+  // `more`'s values belong to tokens numbered from its own first token.
+  size_t base = tokens->base + i - more->base;
+  for (size_t j = 0; j < more->value_count; j++) {
+    tokens->values[tokens->value_count + j] = more->values[j];
+    tokens->value_tokens[tokens->value_count + j] = more->value_tokens[j] + base;
+  }
+  tokens->value_count = count;
+}
+
+// Drops every token numbered before `before`, which nothing will look at again.
+void tokenized_file_discard(TokenizedFile* tokens, size_t before) {
+  if (before <= tokens->base) return;
+
+  size_t count = before - tokens->base;
+  assert(count <= tokens->length);
+
+  size_t length = tokens->length - count;
+  memmove(tokens->types, tokens->types + count, length * sizeof(unsigned char));
+  memmove(tokens->flags, tokens->flags + count, length * sizeof(unsigned char));
+  memmove(tokens->offsets, tokens->offsets + count, length * sizeof(uint32_t));
+  memmove(tokens->lengths, tokens->lengths + count, length * sizeof(uint32_t));
+  memmove(tokens->symbols, tokens->symbols + count, length * sizeof(uint32_t));
+  tokens->length = length;
+  tokens->base = before;
+
+  // Values are kept in token order, so the discarded tokens own exactly the
+  // first few of them.
+  size_t values = _tokenized_file_find_value(tokens, before);
+  if (values == 0) return;
+
+  tokens->value_count -= values;
+  memmove(tokens->values, tokens->values + values, tokens->value_count * sizeof(uint64_t));
+  memmove(tokens->value_tokens, tokens->value_tokens + values, tokens->value_count * sizeof(uint32_t));
+}
+
+void free_tokenized_file(TokenizedFile* tokens) {
+  free(tokens->types);
+  free(tokens->flags);
+  free(tokens->offsets);
+  free(tokens->lengths);
+  free(tokens->symbols);
+  free(tokens->values);
+  free(tokens->value_tokens);
+}
+
+
+// ** Accessors ** //
+
+bool token_is_held(TokenizedFile* tokens, size_t i) {
+  return i >= tokens->base && i < tokens->base + tokens->length;
+}
+
+// The rest all require that token `i` is held.
+
+TokenType token_type(TokenizedFile* tokens, size_t i) {
+  return tokens->types[i - tokens->base];
+}
+
+Symbol token_symbol(TokenizedFile* tokens, size_t i) {
+  return tokens->symbols[i - tokens->base];
+}
+
+TokenLiteralType token_literal_type(TokenizedFile* tokens, size_t i) {
+  return (tokens->flags[i - tokens->base] & TOKEN_LITERAL_MASK) << TOKEN_LITERAL_SHIFT;
+}
+
+bool token_is_well_formed(TokenizedFile* tokens, size_t i) {
+  return (tokens->flags[i - tokens->base] & TOKEN_WELL_FORMED) != 0;
+}
+
+LiteralWidth token_literal_width(TokenizedFile* tokens, size_t i) {
+  return (tokens->flags[i - tokens->base] & TOKEN_WIDTH_MASK) << TOKEN_LITERAL_SHIFT;
+}
+
+// @Precondition: the token is an integer literal.
+uint64_t token_value(TokenizedFile* tokens, size_t i) {
+  size_t index = _tokenized_file_find_value(tokens, i);
+  assert(index < tokens->value_count && tokens->value_tokens[index] == i);
+  return tokens->values[index];
+}
+
+FileAddress token_offset(TokenizedFile* tokens, size_t i) {
+  return tokens->offsets[i - tokens->base];
+}
+
+FileAddress token_end_offset(TokenizedFile* tokens, size_t i) {
+  return tokens->offsets[i - tokens->base] + tokens->lengths[i - tokens->base];
+}
+
+String token_source(TokenizedFile* tokens, size_t i) {
+  return (String) { tokens->lengths[i - tokens->base], tokens->source->data + tokens->offsets[i - tokens->base] };
+}
+
+#undef TOKEN_LITERAL_SHIFT
+#undef TOKEN_LITERAL_MASK
+#undef TOKEN_WIDTH_MASK
+#undef TOKEN_WELL_FORMED
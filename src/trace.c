@@ -0,0 +1,135 @@
+// Records a span for every job run by the pipeline (and every background task
+// run by the scheduler), and writes them out in Chrome's trace-event format for
+// viewing in about:tracing or Perfetto.
+//
+// Tracing is off unless `--trace` was given, in which case spans may be
+// recorded from any thread.
+
+typedef struct {
+  char* name;
+  FileInfo* file;     // NULL if the span isn't tied to a file.
+  char* node_key;     // NULL if the span isn't tied to a node.
+  size_t node_id;
+  size_t attempt;
+  char* result;       // NULL if the span has no outcome to report.
+
+  double start;
+  double duration;
+  pid_t tid;
+} TraceEvent;
+
+typedef struct {
+  pthread_mutex_t lock;
+  Pool events;
+  double epoch;
+} Trace;
+
+Trace* __trace = NULL;
+
+
+double trace_now() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+void trace_begin() {
+  __trace = malloc(sizeof(Trace));
+  pthread_mutex_init(&__trace->lock, NULL);
+  initialize_pool(&__trace->events, sizeof(TraceEvent), 16, 256);
+  __trace->epoch = trace_now();
+}
+
+void trace_record(TraceEvent event, double started) {
+  if (__trace == NULL) return;
+
+  event.start = started;
+  event.duration = trace_now() - started;
+  event.tid = syscall(SYS_gettid);
+
+  pthread_mutex_lock(&__trace->lock);
+  *((TraceEvent*) pool_get(&__trace->events)) = event;
+  pthread_mutex_unlock(&__trace->lock);
+}
+
+void trace_record_job(Job* job, double started, bool completed) {
+  if (__trace == NULL) return;
+
+  TraceEvent event = { StageNames[job->type], job->file };
+  event.attempt = job->attempts + 1;
+  event.result = completed ? "completed" : "requeued";
+
+  if (job->type == JOB_EXECUTE) {
+    event.node_key = "bytecode_id";
+    event.node_id = job->vm_state->id;
+  } else if (job->type >= JOB_TYPECHECK) {
+    event.node_key = "node_id";
+    event.node_id = job->node->id;
+  }
+
+  trace_record(event, started);
+}
+
+
+// ** Output ** //
+
+void _write_json_string(FILE* out, String* str) {
+  fputc('"', out);
+  for (size_t i = 0; i < str->length; i++) {
+    unsigned char c = str->data[i];
+    if (c == '"' || c == '\\') {
+      fprintf(out, "\\%c", c);
+    } else if (c < 0x20) {
+      fprintf(out, "\\u%04x", c);
+    } else {
+      fputc(c, out);
+    }
+  }
+  fputc('"', out);
+}
+
+void _write_trace_event(FILE* out, TraceEvent* event, pid_t pid) {
+  fprintf(out, "{\"name\": \"%s\", \"cat\": \"pipeline\", \"ph\": \"X\", \"pid\": %d, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f, \"args\": {",
+          event->name, pid, event->tid, (event->start - __trace->epoch) * 1e6, event->duration * 1e6);
+
+  char* separator = "";
+  if (event->file != NULL) {
+    fprintf(out, "\"file\": ");
+    _write_json_string(out, event->file->filename);
+    separator = ", ";
+  }
+  if (event->node_key != NULL) {
+    fprintf(out, "%s\"%s\": %zu", separator, event->node_key, event->node_id);
+    separator = ", ";
+  }
+  if (event->result != NULL) {
+    fprintf(out, "%s\"attempt\": %zu, \"result\": \"%s\"", separator, event->attempt, event->result);
+  }
+
+  fprintf(out, "}}");
+}
+
+// Writes every recorded span to `filename`, returning zero on failure.
+bool trace_write(char* filename) {
+  FILE* out = fopen(filename, "w");
+  if (out == NULL) return 0;
+
+  pid_t pid = getpid();
+  pthread_mutex_lock(&__trace->lock);
+
+  TraceEvent* events = pool_to_array(&__trace->events);
+  size_t length = __trace->events.length;
+
+  fprintf(out, "{\"traceEvents\": [\n");
+  for (size_t i = 0; i < length; i++) {
+    _write_trace_event(out, &events[i], pid);
+    fprintf(out, i + 1 < length ? ",\n" : "\n");
+  }
+  fprintf(out, "], \"displayTimeUnit\": \"ms\"}\n");
+
+  pthread_mutex_unlock(&__trace->lock);
+
+  free(events);
+  fclose(out);
+  return 1;
+}
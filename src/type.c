@@ -1,7 +1,7 @@
-void* type_create_untracked(String* name, size_t size) {
+void* type_create_untracked(CompilationWorkspace* ws, String* name, size_t size) {
   static size_t serial = 0;  // @TODO Don't use static...
 
-  Typeclass* type = calloc(1, sizeof(Typeclass));
+  Typeclass* type = arena_alloc(&ws->arena, sizeof(Typeclass));
   type->id = serial++;
   type->size = size;
   type->name = name;
@@ -14,7 +14,7 @@ void type_alias(CompilationWorkspace* ws, String* name, Typeclass* type) {
 }
 
 void* type_create(CompilationWorkspace* ws, String* name, size_t size) {
-  Typeclass* type = type_create_untracked(name, size);
+  Typeclass* type = type_create_untracked(ws, name, size);
   type_alias(ws, name, type);
   return type;
 }
@@ -39,11 +39,12 @@ AstNode* _find_identifier(Scope* scope, Symbol ident) {
 bool typecheck_node(Job* job, AstNode* node);
 
 bool typecheck_type(Job* job, AstNode* node) {
-  Typeclass* type = type_find(job->ws, &node->source);
+  String source = node_source(job->file->source, node);
+  Typeclass* type = type_find(job->ws, &source);
 
   if (type == NULL) {
     node->flags |= NODE_CONTAINS_ERROR;
-    node->error = ERR_UNDEFINED_TYPE;
+    node_set_error(job->ws, node, ERR_UNDEFINED_TYPE);
     return 0;
   }
 
@@ -52,12 +53,12 @@ bool typecheck_type(Job* job, AstNode* node) {
 }
 
 bool typecheck_declaration(Job* job, AstNode* node) {
-  AstNode* type = node->rhs;
+  AstNode* type = node_rhs(node);
 
   // This is the basic deferred type inference case.
   if (type == NULL) {
     node->flags |= NODE_CONTAINS_ERROR;
-    node->error = ERR_COULD_NOT_INFER_TYPE;
+    node_set_error(job->ws, node, ERR_COULD_NOT_INFER_TYPE);
     return 1;
   }
 
@@ -66,17 +67,19 @@ bool typecheck_declaration(Job* job, AstNode* node) {
   node->typeclass = type->typeclass;
   if (node->typeclass == NULL) {
     node->flags |= NODE_CONTAINS_ERROR;
-    node->error = NULL;
+    node_set_error(job->ws, node, NULL);
+  } else {
+    pipeline_wake(job->ws, node);
   }
 
   return result;
 }
 
 bool typecheck_assignment(Job* job, AstNode* node) {
-  AstNode* target = _find_identifier(node->scope, node->lhs->ident);
-  AstNode* value = node->rhs;
+  AstNode* target = _find_identifier(node->scope, node_lhs(node)->ident);
+  AstNode* value = node_rhs(node);
 
-  node->lhs = target;
+  node->declaration = target;
 
   assert(target != NULL);
   assert(value != NULL);
@@ -97,7 +100,8 @@ bool typecheck_assignment(Job* job, AstNode* node) {
   if (target->typeclass == NULL) {
     target->typeclass = value->typeclass;
     target->flags &= ~NODE_CONTAINS_ERROR;
-    target->error = NULL;
+    node_set_error(job->ws, target, NULL);
+    pipeline_wake(job->ws, target);
 
     node->typeclass = target->typeclass;
     node->flags &= (value->flags & NODE_CONTAINS_ERROR);
@@ -107,7 +111,7 @@ bool typecheck_assignment(Job* job, AstNode* node) {
 
     if (!result) {
       node->flags |= NODE_CONTAINS_ERROR;
-      node->error = ERR_INCOMPATIBLE_TYPES;
+      node_set_error(job->ws, node, ERR_INCOMPATIBLE_TYPES);
       return 1;
     }
 
@@ -125,13 +129,17 @@ bool typecheck_expression_identifier(Job* job, AstNode* node) {
 
   if (decl == NULL) {
     node->flags |= NODE_CONTAINS_ERROR;
-    node->error = ERR_UNDECLARED_IDENT;
+    node_set_error(job->ws, node, ERR_UNDECLARED_IDENT);
+    pipeline_block_on(job->ws, NULL);
     return 0;
   }
 
   node->flags |= (decl->flags & NODE_CONTAINS_ERROR);
 
-  if (decl->typeclass == NULL) return 0;
+  if (decl->typeclass == NULL) {
+    pipeline_block_on(job->ws, decl);
+    return 0;
+  }
 
   // @TODO Type concretization should back propagate through intermediate
   //       variables.
@@ -142,74 +150,23 @@ bool typecheck_expression_identifier(Job* job, AstNode* node) {
 }
 
 DEFINE_STR(STR_LITERAL, "<literal>");
-void _type_literal_number_value(AstNode* node) {
+void _type_literal_number_value(Job* job, AstNode* node) {
   // @TODO Describe all possible types.
-  node->typeclass = type_create_untracked(STR_LITERAL, 0);
+  node->typeclass = type_create_untracked(job->ws, STR_LITERAL, LITERAL_WIDTH_BITS(node->flags));
   node->typeclass->kind = KIND_LITERAL | KIND_NUMERIC;
 }
 
-bool typecheck_expression_literal_decimal(Job* job, AstNode* node) {
-  node->int_value = 0;
-
-  for (int i = 0; i < node->source.length; i++) {
-    char c = node->source.data[i];
-    if (c == '_') continue;
-
-    node->int_value *= 10;
-    node->int_value += c - '0';
-  }
-
-  _type_literal_number_value(node);
-
-  return 1;
-}
-
-bool typecheck_expression_literal_hex(Job* job, AstNode* node) {
-  node->int_value = 0;
-
-  assert(node->source.data[0] == '0');
-  assert(node->source.data[1] == 'x');
-
-  for (int i = 2; i < node->source.length; i++) {
-    char c = node->source.data[i];
-    if (c == '_') continue;
-
-    node->int_value *= 16;
-    if (c >= '0' && c <= '9') {
-      node->int_value += c - '0';
-    } else if (c >= 'a' && c <= 'z') {
-      node->int_value += 10 + c - 'a';
-    } else {
-      node->int_value += 10 + c - 'A';
-    }
-  }
-
-  _type_literal_number_value(node);
-
-  return 1;
-}
-
-bool typecheck_expression_literal_binary(Job* job, AstNode* node) {
-  node->int_value = 0;
-
-  assert(node->source.data[0] == '0');
-  assert(node->source.data[1] == 'b');
-
-  for (int i = 2; i < node->source.length; i++) {
-    char c = node->source.data[i];
-    if (c == '_') continue;
-
-    node->int_value *= 2;
-    node->int_value += c - '0';
-  }
-
-  _type_literal_number_value(node);
+// Integer literals' values and widths were computed by the lexer, and carried
+// over by the parser.
+bool typecheck_expression_literal_integer(Job* job, AstNode* node) {
+  _type_literal_number_value(job, node);
 
   return 1;
 }
 
 bool typecheck_expression_literal_fractional(Job* job, AstNode* node) {
-  node->double_value = strtod(to_zero_terminated_string(&node->source), NULL);
+  String source = node_source(job->file->source, node);
+  node->double_value = strtod(to_zero_terminated_string(&source), NULL);
 
   node->typeclass = type_find(job->ws, STR_FLOAT);
 
@@ -217,38 +174,36 @@ bool typecheck_expression_literal_fractional(Job* job, AstNode* node) {
 }
 
 bool typecheck_expression_literal_string(Job* job, AstNode* node) {
-  node->pointer_value = unescape_string_literal(&node->source);
+  String source = node_source(job->file->source, node);
+  node->pointer_value = unescape_string_literal(&source);
   node->typeclass = type_find(job->ws, STR_STRING);
 
   return 1;
 }
 
 bool typecheck_expression_literal(Job* job, AstNode* node) {
-  if (node->flags & IS_DECIMAL_LITERAL) {
-    return typecheck_expression_literal_decimal(job, node);
-  } else if (node->flags & IS_HEX_LITERAL) {
-    return typecheck_expression_literal_hex(job, node);
-  } else if (node->flags & IS_BINARY_LITERAL) {
-    return typecheck_expression_literal_binary(job, node);
+  if (node->flags & (IS_DECIMAL_LITERAL | IS_HEX_LITERAL | IS_BINARY_LITERAL)) {
+    return typecheck_expression_literal_integer(job, node);
   } else if (node->flags & IS_FRACTIONAL_LITERAL) {
     return typecheck_expression_literal_fractional(job, node);
   } else if (node->flags & IS_STRING_LITERAL) {
     return typecheck_expression_literal_string(job, node);
   } else {
     node->flags |= NODE_CONTAINS_ERROR;
-    node->error = ERR_UNHANDLED_LITERAL_TYPE;
+    node_set_error(job->ws, node, ERR_UNHANDLED_LITERAL_TYPE);
     return 1;
   }
 }
 
 bool typecheck_expression_procedure(Job* job, AstNode* node) {
-  AstNode* arguments = node->lhs;
-  AstNode* returns = node->rhs;
+  AstNode* arguments = node_lhs(node);
+  AstNode* returns = node_rhs(node);
+  AstNode* argument = node_body(arguments);
+  AstNode* returned = node_body(returns);
 
   assert(arguments != NULL);
   assert(returns != NULL);
   assert(node->body_length == 1);
-  assert(node->body != NULL);
 
   List* argument_types = new_list(1, arguments->body_length);
   List* return_types = new_list(1, returns->body_length);
@@ -257,37 +212,41 @@ bool typecheck_expression_procedure(Job* job, AstNode* node) {
   size_t typestring_length = 8;  // "() => ()"
 
   for (size_t i = 0; i < arguments->body_length; i++) {
-    success &= typecheck_node(job, &arguments->body[i]);
-    arguments->flags |= (arguments->body[i].flags & NODE_CONTAINS_ERROR);
-    node->flags |= (arguments->body[i].flags & NODE_CONTAINS_ERROR);
+    success &= typecheck_node(job, &argument[i]);
+    arguments->flags |= (argument[i].flags & NODE_CONTAINS_ERROR);
+    node->flags |= (argument[i].flags & NODE_CONTAINS_ERROR);
 
     if (success) {
       if (i > 0) typestring_length += 2;  // ", "
-      typestring_length += arguments->body[i].typeclass->name->length;
-      list_append(argument_types, arguments->body[i].typeclass);
+      typestring_length += argument[i].typeclass->name->length;
+      list_append(argument_types, argument[i].typeclass);
     }
   }
   for (size_t i = 0; i < returns->body_length; i++) {
-    success &= typecheck_node(job, &returns->body[i]);
-    returns->flags |= (returns->body[i].flags & NODE_CONTAINS_ERROR);
-    node->flags |= (returns->body[i].flags & NODE_CONTAINS_ERROR);
+    success &= typecheck_node(job, &returned[i]);
+    returns->flags |= (returned[i].flags & NODE_CONTAINS_ERROR);
+    node->flags |= (returned[i].flags & NODE_CONTAINS_ERROR);
 
     if (success) {
       if (i > 0) typestring_length += 2;  // ", "
-      typestring_length += returns->body[i].typeclass->name->length;
-      list_append(return_types, returns->body[i].typeclass);
+      typestring_length += returned[i].typeclass->name->length;
+      list_append(return_types, returned[i].typeclass);
     }
   }
 
   if (success) {
-    pipeline_emit_typecheck_job(job->ws, job->file, node->body);
+    pipeline_emit_typecheck_job(job->ws, job->file, node_body(node));
 
-    char* _name = malloc(typestring_length * sizeof(char));
+    String* name = arena_alloc(&job->ws->arena, sizeof(String) + typestring_length * sizeof(char));
+    name->length = typestring_length;
+    name->data = (char*) (name + 1);
+
+    char* _name = name->data;
     char* pos = _name + 1;
     _name[0] = '(';
 
     for (size_t i = 0; i < arguments->body_length; i++) {
-      String* type_name = arguments->body[i].typeclass->name;
+      String* type_name = argument[i].typeclass->name;
 
       if (i > 0) {
         pos[0] = ',';
@@ -308,7 +267,7 @@ bool typecheck_expression_procedure(Job* job, AstNode* node) {
     pos += 6;
 
     for (size_t i = 0; i < returns->body_length; i++) {
-      String* type_name = returns->body[i].typeclass->name;
+      String* type_name = returned[i].typeclass->name;
 
       if (i > 0) {
         pos[0] = ',';
@@ -322,26 +281,20 @@ bool typecheck_expression_procedure(Job* job, AstNode* node) {
 
     pos[0] = ')';
 
-    String* name = malloc(sizeof(String));
-    name->length = typestring_length;
-    name->data = _name;
-
     node->typeclass = type_find(job->ws, name);
 
     if (node->typeclass == NULL) {
       node->typeclass = type_create(job->ws, name, 64);
       node->typeclass->from = argument_types;
       node->typeclass->to = return_types;
+      return success;
     }
-
-    // @TODO Maybe don't allocate these unless they're necessary?
-    free_list(argument_types);
-    free_list(return_types);
-
-    // @Leak: String data is never reclaimed.
-    // @Leak: String container is never reclaimed.
   }
 
+  // @TODO Maybe don't allocate these unless they're necessary?
+  free_list(argument_types);
+  free_list(return_types);
+
   return success;
 }
 
@@ -350,45 +303,47 @@ bool typecheck_expression_call(Job* job, AstNode* node) {
 
   if (decl == NULL) {
     node->flags |= NODE_CONTAINS_ERROR;
-    node->error = ERR_UNDECLARED_IDENT;
+    node_set_error(job->ws, node, ERR_UNDECLARED_IDENT);
+    pipeline_block_on(job->ws, NULL);
     return 0;
   }
 
   if (decl->typeclass == NULL) {
     node->flags |= NODE_CONTAINS_ERROR;
-    node->error = ERR_COULD_NOT_INFER_TYPE;
+    node_set_error(job->ws, node, ERR_COULD_NOT_INFER_TYPE);
+    pipeline_block_on(job->ws, decl);
     return 0;
   }
 
   assert(decl->typeclass->from != NULL);
   assert(decl->typeclass->to != NULL);
 
-  bool success = 1;
-  for (size_t i = 0; i < node->rhs->body_length; i++) {
-    AstNode* arg = &node->rhs->body[i];
+  AstNode* args = node_rhs(node);
+  AstNode* arg = node_body(args);
 
-    success &= typecheck_node(job, arg);
-    node->rhs->flags |= (arg->flags & NODE_CONTAINS_ERROR);
+  bool success = 1;
+  for (size_t i = 0; i < args->body_length; i++) {
+    success &= typecheck_node(job, &arg[i]);
+    args->flags |= (arg[i].flags & NODE_CONTAINS_ERROR);
   }
-  node->flags |= (node->rhs->flags & NODE_CONTAINS_ERROR);
+  node->flags |= (args->flags & NODE_CONTAINS_ERROR);
   if (!success) return 0;
 
   List* arg_types = decl->typeclass->from;
-  if (node->rhs->body_length != arg_types->length) {
+  if (args->body_length != arg_types->length) {
     node->flags |= NODE_CONTAINS_ERROR;
-    node->error = ERR_ARGUMENT_TYPE_MISMATCH;
+    node_set_error(job->ws, node, ERR_ARGUMENT_TYPE_MISMATCH);
     return 0;
   }
 
   for (size_t i = 0; i < arg_types->length; i++){
-    AstNode* arg = &node->rhs->body[i];
     Typeclass* arg_type = list_get(arg_types, i);
 
-    if (arg->typeclass != arg_type) {
+    if (arg[i].typeclass != arg_type) {
       node->flags |= NODE_CONTAINS_ERROR;
-      node->rhs->flags |= NODE_CONTAINS_ERROR;
-      arg->flags |= NODE_CONTAINS_ERROR;
-      arg->error = ERR_ARGUMENT_TYPE_MISMATCH;
+      args->flags |= NODE_CONTAINS_ERROR;
+      arg[i].flags |= NODE_CONTAINS_ERROR;
+      node_set_error(job->ws, &arg[i], ERR_ARGUMENT_TYPE_MISMATCH);
       return 0;
     }
   }
@@ -409,10 +364,11 @@ bool typecheck_return(Job* job, AstNode* node) {
   bool result = 1;
 
   if (node->flags & NODE_CONTAINS_RHS) {
-    result = typecheck_node(job, node->rhs);
+    AstNode* value = node_rhs(node);
+    result = typecheck_node(job, value);
 
     if (result) {
-      node->typeclass = node->rhs->typeclass;
+      node->typeclass = value->typeclass;
     }
   } else {
     node->typeclass = type_find(job->ws, STR_VOID);
@@ -432,18 +388,18 @@ bool typecheck_expression(Job* job, AstNode* node) {
     return typecheck_expression_call(job, node);
   } else {
     node->flags |= NODE_CONTAINS_ERROR;
-    node->error = ERR_UNHANDLED_EXPRESSION_TYPE;
+    node_set_error(job->ws, node, ERR_UNHANDLED_EXPRESSION_TYPE);
     return 1;
   }
 }
 
 bool typecheck_compound(Job* job, AstNode* node) {
   bool result = 1;
+  AstNode* body = node_body(node);
 
   for (size_t i = 0; i < node->body_length; i++) {
-    AstNode* child = &node->body[i];
-    result &= typecheck_node(job, child);
-    node->flags |= (child->flags & NODE_CONTAINS_ERROR);
+    result &= typecheck_node(job, &body[i]);
+    node->flags |= (body[i].flags & NODE_CONTAINS_ERROR);
   }
 
   if (result) {
@@ -455,17 +411,16 @@ bool typecheck_compound(Job* job, AstNode* node) {
 
 bool typecheck_conditional(Job* job, AstNode* node) {
   bool result = 1;
-  AstNode* condition = node->lhs;
-  AstNode* body = node->body;
+  AstNode* condition = node_lhs(node);
+  AstNode* body = node_body(node);
 
   result = typecheck_node(job, condition);
   if (!result) return result;
 
   if (condition->typeclass != type_find(job->ws, STR_BOOL)) {
     node->flags |= NODE_CONTAINS_ERROR;
-    node->lhs->flags |= NODE_CONTAINS_ERROR;
     condition->flags |= NODE_CONTAINS_ERROR;
-    condition->error = ERR_INCOMPATIBLE_TYPES;
+    node_set_error(job->ws, condition, ERR_INCOMPATIBLE_TYPES);
     return 0;
   }
 
@@ -477,7 +432,7 @@ bool typecheck_conditional(Job* job, AstNode* node) {
 
 bool typecheck_loop(Job* job, AstNode* node) {
   bool result = 1;
-  AstNode* block = node->body;
+  AstNode* block = node_body(node);
 
   result = typecheck_node(job, block);
   node->typeclass = type_find(job->ws, STR_VOID);
@@ -522,7 +477,7 @@ bool typecheck_node(Job* job, AstNode* node) {
       break;
     default:
       node->flags |= NODE_CONTAINS_ERROR;
-      node->error = ERR_UNHANDLED_NODE_TYPE;
+      node_set_error(job->ws, node, ERR_UNHANDLED_NODE_TYPE);
       result = 1;
   }
   // printf("typecheck_node <- "); inspect_ast_node(node); printf("\n");
@@ -534,7 +489,7 @@ bool perform_typecheck_job(Job* job) {
   bool result = typecheck_node(job, job->node);
 
   // printf("«««««««»»»»»»»\n");
-  // print_ast_node_as_tree(job->file->lines, job->node);
+  // print_ast_node_as_tree(job->file->source, job->node);
   // printf("«««««««»»»»»»»\n");
 
   if (result) {
@@ -0,0 +1,128 @@
+// UTF-8 decoding and validation, and the classification of non-ASCII
+// identifier characters.
+//
+// Source files are almost always pure ASCII, so validation skips over ASCII
+// a vector at a time, and only decodes sequences one by one once it finds a
+// byte at or above 0x80.
+
+// Decodes the sequence at `pos` into `codepoint`, returning its length in
+// bytes, or zero if it isn't valid UTF-8 (including overlong encodings,
+// surrogates, and sequences cut short by the end of the input).
+size_t utf8_decode(const char* data, size_t pos, size_t length, uint32_t* codepoint) {
+  const unsigned char* bytes = (const unsigned char*) data + pos;
+  size_t available = length - pos;
+
+  size_t size;
+  uint32_t value;
+  uint32_t minimum;
+
+  if (bytes[0] < 0x80) {
+    *codepoint = bytes[0];
+    return 1;
+  } else if (bytes[0] >= 0xC2 && bytes[0] <= 0xDF) {
+    size = 2;
+    value = bytes[0] & 0x1F;
+    minimum = 0x80;
+  } else if ((bytes[0] & 0xF0) == 0xE0) {
+    size = 3;
+    value = bytes[0] & 0x0F;
+    minimum = 0x800;
+  } else if (bytes[0] >= 0xF0 && bytes[0] <= 0xF4) {
+    size = 4;
+    value = bytes[0] & 0x07;
+    minimum = 0x10000;
+  } else {
+    return 0;
+  }
+
+  if (available < size) return 0;
+
+  for (size_t i = 1; i < size; i++) {
+    if ((bytes[i] & 0xC0) != 0x80) return 0;
+    value = (value << 6) | (bytes[i] & 0x3F);
+  }
+
+  if (value < minimum || value > 0x10FFFF) return 0;
+  if (value >= 0xD800 && value <= 0xDFFF) return 0;
+
+  *codepoint = value;
+  return size;
+}
+
+// Returns the offset of the first byte at or after `pos` which doesn't begin
+// a valid UTF-8 sequence, or `length` if the whole input is valid.
+size_t utf8_validate(const Scanners* scan, const char* data, size_t pos, size_t length) {
+  while (1) {
+    pos = scan->ascii(data, pos, length);
+    if (pos == length) return length;
+
+    uint32_t codepoint;
+    size_t size = utf8_decode(data, pos, length, &codepoint);
+    if (size == 0) return pos;
+
+    pos += size;
+  }
+}
+
+
+// ** Identifiers ** //
+
+typedef struct {
+  uint32_t first;
+  uint32_t last;
+} CodepointRange;
+
+// Characters allowed in identifiers, from C11 Annex D.1.
+static const CodepointRange IDENTIFIER_RANGES[] = {
+  { 0x00A8, 0x00A8 }, { 0x00AA, 0x00AA }, { 0x00AD, 0x00AD }, { 0x00AF, 0x00AF },
+  { 0x00B2, 0x00B5 }, { 0x00B7, 0x00BA }, { 0x00BC, 0x00BE }, { 0x00C0, 0x00D6 },
+  { 0x00D8, 0x00F6 }, { 0x00F8, 0x00FF }, { 0x0100, 0x167F }, { 0x1681, 0x180D },
+  { 0x180F, 0x1FFF }, { 0x200B, 0x200D }, { 0x202A, 0x202E }, { 0x203F, 0x2040 },
+  { 0x2054, 0x2054 }, { 0x2060, 0x206F }, { 0x2070, 0x218F }, { 0x2460, 0x24FF },
+  { 0x2776, 0x2793 }, { 0x2C00, 0x2DFF }, { 0x2E80, 0x2FFF }, { 0x3004, 0x3007 },
+  { 0x3021, 0x302F }, { 0x3031, 0x303F }, { 0x3040, 0xD7FF }, { 0xF900, 0xFD3D },
+  { 0xFD40, 0xFDCF }, { 0xFDF0, 0xFE44 }, { 0xFE47, 0xFFFD },
+  { 0x10000, 0x1FFFD }, { 0x20000, 0x2FFFD }, { 0x30000, 0x3FFFD }, { 0x40000, 0x4FFFD },
+  { 0x50000, 0x5FFFD }, { 0x60000, 0x6FFFD }, { 0x70000, 0x7FFFD }, { 0x80000, 0x8FFFD },
+  { 0x90000, 0x9FFFD }, { 0xA0000, 0xAFFFD }, { 0xB0000, 0xBFFFD }, { 0xC0000, 0xCFFFD },
+  { 0xD0000, 0xDFFFD }, { 0xE0000, 0xEFFFD },
+};
+
+// Characters which may not begin an identifier, from C11 Annex D.2.
+static const CodepointRange NONINITIAL_RANGES[] = {
+  { 0x0300, 0x036F }, { 0x1DC0, 0x1DFF }, { 0x20D0, 0x20FF }, { 0xFE20, 0xFE2F },
+};
+
+bool _codepoint_in_ranges(uint32_t codepoint, const CodepointRange* ranges, size_t count) {
+  size_t lo = 0;
+  size_t hi = count;
+
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (codepoint < ranges[mid].first) {
+      hi = mid;
+    } else if (codepoint > ranges[mid].last) {
+      lo = mid + 1;
+    } else {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+bool is_identifier_codepoint(uint32_t codepoint, bool initial) {
+  if (!_codepoint_in_ranges(codepoint, IDENTIFIER_RANGES, sizeof(IDENTIFIER_RANGES) / sizeof(CodepointRange))) return 0;
+  if (initial && _codepoint_in_ranges(codepoint, NONINITIAL_RANGES, sizeof(NONINITIAL_RANGES) / sizeof(CodepointRange))) return 0;
+  return 1;
+}
+
+// Returns the length of the non-ASCII identifier character at `pos`, or zero
+// if there isn't one there.
+size_t unicode_identifier_length(const char* data, size_t pos, size_t length, bool initial) {
+  uint32_t codepoint;
+  size_t size = utf8_decode(data, pos, length, &codepoint);
+
+  if (size < 2 || !is_identifier_codepoint(codepoint, initial)) return 0;
+  return size;
+}
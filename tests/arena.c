@@ -0,0 +1,55 @@
+void test_arena_alloc() {
+  Arena arena;
+
+  TEST("Allocating from an arena");
+  initialize_arena(&arena);
+  ASSERT_EQ((void*) arena.chunks, NULL, "has no chunks until something is allocated");
+
+  char* a = arena_alloc(&arena, 3);
+  char* b = arena_alloc(&arena, 8);
+  ASSERT_EQ((size_t) a % 16, 0, "aligns the first allocation");
+  ASSERT_EQ((size_t) b % 16, 0, "aligns subsequent allocations");
+  ASSERT_EQ((size_t) (b - a), 16, "allocates adjacent slots from the same chunk");
+  ASSERT_EQ(arena.allocated, 32, "counts the (rounded up) bytes allocated");
+  ASSERT_EQ((a[0] | a[1] | a[2] | b[7]), 0, "hands out zeroed memory");
+
+  ArenaChunk* first = arena.chunks;
+  for (size_t i = 0; i < ARENA_CHUNK_SIZE / 64; i++) arena_alloc(&arena, 64);
+  ASSERT_NOT_EQ((void*) arena.chunks, (void*) first, "starts a new chunk once one fills up");
+  ASSERT_EQ((void*) arena.chunks->next, (void*) first, "keeps the older chunks");
+
+  ArenaChunk* current = arena.chunks;
+  char* large = arena_alloc(&arena, ARENA_CHUNK_SIZE);
+  large[ARENA_CHUNK_SIZE - 1] = 'x';
+  ASSERT_EQ((void*) arena.chunks, (void*) current, "gives large allocations a chunk of their own");
+  ASSERT_EQ((void*) arena.chunks->next->data, (void*) large, "keeps large chunks behind the current one");
+
+  free_arena(&arena);
+  ASSERT_EQ((void*) arena.chunks, NULL, "releases every chunk at once");
+}
+
+void test_arena_reset() {
+  Arena arena;
+
+  TEST("Resetting an arena");
+  initialize_arena(&arena);
+  char* a = arena_alloc(&arena, 16);
+  a[0] = 'x';
+  for (size_t i = 0; i < ARENA_CHUNK_SIZE / 64; i++) arena_alloc(&arena, 64);
+  arena_alloc(&arena, ARENA_CHUNK_SIZE);
+
+  arena_reset(&arena);
+  ASSERT_NOT_EQ((void*) arena.chunks, NULL, "keeps a chunk");
+  ASSERT_EQ((void*) arena.chunks->next, NULL, "releases the rest");
+
+  char* b = arena_alloc(&arena, 16);
+  ASSERT_EQ((void*) b, (void*) arena.chunks->data, "allocates from the start of the kept chunk");
+  ASSERT_EQ(b[0], 0, "hands out zeroed memory again");
+
+  free_arena(&arena);
+}
+
+void run_all_arena_tests() {
+  test_arena_alloc();
+  test_arena_reset();
+}
@@ -0,0 +1,105 @@
+void test_atomic_queue_add_and_pull() {
+  AtomicQueue* queue;
+  size_t values[8] = {};
+  void* pulled = NULL;
+
+  TEST("Creating a new atomic queue(5)");
+  queue = new_atomic_queue(5);
+  ASSERT_EQ(atomic_queue_length(queue), 0, "has a length of zero");
+  ASSERT_EQ(queue->capacity, 8, "rounds capacity up to 8 slots");
+  ASSERT_EQ(atomic_queue_pull(queue, &pulled), 0, "reports that it is empty");
+  free_atomic_queue(queue);
+
+  TEST("Adding and pulling items from an atomic queue(4)");
+  queue = new_atomic_queue(4);
+  ASSERT_EQ(atomic_queue_add(queue, &values[0]), 1, "accepts the first value");
+  ASSERT_EQ(atomic_queue_add(queue, &values[1]), 1, "accepts the second value");
+  ASSERT_EQ(atomic_queue_length(queue), 2, "has a length of 2");
+  ASSERT_EQ(atomic_queue_pull(queue, &pulled), 1, "returns a value");
+  ASSERT_EQ(pulled, (void*) &values[0], "returns the value added first");
+  ASSERT_EQ(atomic_queue_pull(queue, &pulled), 1, "returns a value");
+  ASSERT_EQ(pulled, (void*) &values[1], "returns the value added second");
+  ASSERT_EQ(atomic_queue_pull(queue, &pulled), 0, "reports that it is empty");
+  free_atomic_queue(queue);
+
+  TEST("Filling an atomic queue(4)");
+  queue = new_atomic_queue(4);
+  for (int i = 0; i < 4; i++) atomic_queue_add(queue, &values[i]);
+  ASSERT_EQ(atomic_queue_add(queue, &values[4]), 0, "rejects a value when full");
+  ASSERT_EQ(atomic_queue_length(queue), 4, "has a length of 4");
+  atomic_queue_pull(queue, &pulled);
+  ASSERT_EQ(atomic_queue_add(queue, &values[4]), 1, "accepts a value once there's room");
+  for (int i = 1; i < 5; i++) {
+    atomic_queue_pull(queue, &pulled);
+    ASSERT_EQ(pulled, (void*) &values[i], "preserves the order of the values");
+  }
+  free_atomic_queue(queue);
+}
+
+#define ATOMIC_QUEUE_TEST_THREADS  4
+#define ATOMIC_QUEUE_TEST_ITEMS    100000
+
+typedef struct {
+  AtomicQueue* queue;
+  size_t first;
+  _Atomic size_t* remaining;
+  _Atomic char* seen;
+} AtomicQueueTestInfo;
+
+void* _atomic_queue_test_producer(void* data) {
+  AtomicQueueTestInfo* info = data;
+  for (size_t i = 0; i < ATOMIC_QUEUE_TEST_ITEMS; i++) {
+    while (!atomic_queue_add(info->queue, (void*) (info->first + i))) sched_yield();
+  }
+  return NULL;
+}
+
+void* _atomic_queue_test_consumer(void* data) {
+  AtomicQueueTestInfo* info = data;
+  while (atomic_load(info->remaining) > 0) {
+    void* value;
+    if (atomic_queue_pull(info->queue, &value)) {
+      atomic_fetch_add(&info->seen[(size_t) value], 1);
+      atomic_fetch_sub(info->remaining, 1);
+    } else {
+      sched_yield();
+    }
+  }
+  return NULL;
+}
+
+void test_atomic_queue_concurrency() {
+  size_t total = ATOMIC_QUEUE_TEST_THREADS * ATOMIC_QUEUE_TEST_ITEMS;
+  _Atomic size_t remaining = total;
+  _Atomic char* seen = calloc(total, sizeof(_Atomic char));
+
+  AtomicQueue* queue = new_atomic_queue(64);
+  pthread_t producers[ATOMIC_QUEUE_TEST_THREADS];
+  pthread_t consumers[ATOMIC_QUEUE_TEST_THREADS];
+  AtomicQueueTestInfo info[ATOMIC_QUEUE_TEST_THREADS];
+
+  TEST("Sharing an atomic queue between 4 producers and 4 consumers");
+  for (int i = 0; i < ATOMIC_QUEUE_TEST_THREADS; i++) {
+    info[i] = (AtomicQueueTestInfo) { queue, i * ATOMIC_QUEUE_TEST_ITEMS, &remaining, seen };
+    pthread_create(&producers[i], NULL, _atomic_queue_test_producer, &info[i]);
+    pthread_create(&consumers[i], NULL, _atomic_queue_test_consumer, &info[i]);
+  }
+  for (int i = 0; i < ATOMIC_QUEUE_TEST_THREADS; i++) {
+    pthread_join(producers[i], NULL);
+    pthread_join(consumers[i], NULL);
+  }
+
+  size_t exactly_once = 0;
+  for (size_t i = 0; i < total; i++) exactly_once += seen[i] == 1;
+
+  ASSERT_EQ(exactly_once, total, "delivers every value exactly once");
+  ASSERT_EQ(atomic_queue_length(queue), 0, "is left empty");
+
+  free_atomic_queue(queue);
+  free(seen);
+}
+
+void run_all_atomic_queue_tests() {
+  test_atomic_queue_add_and_pull();
+  test_atomic_queue_concurrency();
+}
@@ -0,0 +1,38 @@
+#define TESTING 1
+
+#include <time.h>
+
+#include "src/main.c"
+
+double __now() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+// Runs BODY once, reporting the total time and the time per operation.
+#define BENCHMARK(NAME, OPERATIONS, BODY)  do { double __start = __now(); BODY; double __elapsed = __now() - __start; printf("  %-56s %10.2f ms %10.2f ns/op\n", NAME, __elapsed * 1e3, __elapsed * 1e9 / (OPERATIONS)); } while (0)
+
+// Reports a time measured elsewhere, as throughput in bytes and in some unit.
+#define THROUGHPUT(NAME, SECONDS, BYTES, ITEMS, UNIT)  printf("  %-56s %10.2f ms %10.2f MB/s %10.2f M%s/s\n", NAME, (SECONDS) * 1e3, (BYTES) / (SECONDS) / 1e6, (ITEMS) / (SECONDS) / 1e6, UNIT)
+
+#include "tests/benchmarks/queue.c"
+#include "tests/benchmarks/atomic_queue.c"
+#include "tests/benchmarks/lexer.c"
+#include "tests/benchmarks/parser.c"
+
+int main() {
+  printf("\nQUEUE BENCHMARKS\n");
+  run_all_queue_benchmarks();
+
+  printf("\nATOMIC QUEUE BENCHMARKS\n");
+  run_all_atomic_queue_benchmarks();
+
+  printf("\nLEXER BENCHMARKS\n");
+  run_all_lexer_benchmarks();
+
+  printf("\nPARSER BENCHMARKS\n");
+  run_all_parser_benchmarks();
+
+  return 0;
+}
@@ -0,0 +1,73 @@
+// Each thread alternately adds and pulls, so every thread is both a producer
+// and a consumer; the total work is split evenly between the threads.
+#define ATOMIC_QUEUE_BENCHMARK_ITEMS    (1 << 21)
+#define ATOMIC_QUEUE_BENCHMARK_THREADS  64
+
+typedef struct {
+  void* queue;
+  pthread_mutex_t* lock;
+  size_t count;
+} AtomicQueueBenchmarkInfo;
+
+void* _atomic_queue_benchmark_worker(void* data) {
+  AtomicQueueBenchmarkInfo* info = data;
+  AtomicQueue* queue = info->queue;
+  void* value;
+
+  for (size_t i = 0; i < info->count; i++) {
+    while (!atomic_queue_add(queue, (void*) i)) sched_yield();
+    while (!atomic_queue_pull(queue, &value)) sched_yield();
+  }
+  return NULL;
+}
+
+void* _locked_queue_benchmark_worker(void* data) {
+  AtomicQueueBenchmarkInfo* info = data;
+  Queue* queue = info->queue;
+
+  for (size_t i = 0; i < info->count; i++) {
+    pthread_mutex_lock(info->lock);
+    queue_add(queue, (void*) i);
+    pthread_mutex_unlock(info->lock);
+
+    pthread_mutex_lock(info->lock);
+    queue_pull(queue);
+    pthread_mutex_unlock(info->lock);
+  }
+  return NULL;
+}
+
+void _run_queue_benchmark_threads(void* (*worker)(void*), void* queue, pthread_mutex_t* lock, size_t thread_count) {
+  pthread_t threads[ATOMIC_QUEUE_BENCHMARK_THREADS];
+  AtomicQueueBenchmarkInfo info = { queue, lock, ATOMIC_QUEUE_BENCHMARK_ITEMS / thread_count };
+
+  for (size_t i = 0; i < thread_count; i++) pthread_create(&threads[i], NULL, worker, &info);
+  for (size_t i = 0; i < thread_count; i++) pthread_join(threads[i], NULL);
+}
+
+void benchmark_atomic_queue_contention() {
+  size_t n = ATOMIC_QUEUE_BENCHMARK_ITEMS;
+  char name[64];
+
+  for (size_t threads = 1; threads <= ATOMIC_QUEUE_BENCHMARK_THREADS; threads <<= 1) {
+    Queue queue;
+    pthread_mutex_t lock;
+    initialize_queue(&queue, 256);
+    pthread_mutex_init(&lock, NULL);
+
+    snprintf(name, sizeof(name), "Queue + mutex: add one, pull one (%zu threads)", threads);
+    BENCHMARK(name, 2 * n, _run_queue_benchmark_threads(_locked_queue_benchmark_worker, &queue, &lock, threads));
+
+    pthread_mutex_destroy(&lock);
+    free(queue.items);
+
+    AtomicQueue* atomic_queue = new_atomic_queue(256);
+    snprintf(name, sizeof(name), "AtomicQueue: add one, pull one (%zu threads)", threads);
+    BENCHMARK(name, 2 * n, _run_queue_benchmark_threads(_atomic_queue_benchmark_worker, atomic_queue, NULL, threads));
+    free_atomic_queue(atomic_queue);
+  }
+}
+
+void run_all_atomic_queue_benchmarks() {
+  benchmark_atomic_queue_contention();
+}
@@ -0,0 +1,285 @@
+// Synthetic source for the lexer and parser benchmarks.  The generator walks
+// the grammar in `Grammar.md`, weighting its choices by a profile so that each
+// corpus leans on a different part of the lexer.  It's seeded, so the same
+// profile and size always produce the same source.
+
+typedef struct {
+  const char* name;
+  unsigned int identifiers;  // Relative weights of identifier and literal leaves.
+  unsigned int literals;
+  unsigned int comments;     // Chance, in 16, of a comment after each line.
+  unsigned int nesting;      // Chance, in 16, that an expression nests further.
+  unsigned int depth;        // How deeply expressions may nest.
+  bool operators;            // Whether to use parentheses and binary operators, which don't parse yet.
+} CorpusProfile;
+
+static const CorpusProfile CORPUS_PROFILES[] = {
+  { "identifier-heavy", 15,  1,  0,  4,  3, 1 },
+  { "literal-heavy",     1, 15,  0,  4,  3, 1 },
+  { "comment-heavy",     8,  8, 12,  4,  3, 1 },
+  { "deeply nested",     8,  8,  0, 15, 40, 1 },
+};
+
+typedef struct {
+  const CorpusProfile* profile;
+  uint64_t seed;
+  size_t indent;
+
+  char* data;
+  size_t length;
+  size_t capacity;
+} Corpus;
+
+// xorshift64*; good enough, and the same everywhere.
+uint64_t _random_below(uint64_t* state, uint64_t bound) {
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return (*state * 0x2545F4914F6CDD1DULL >> 32) % bound;
+}
+
+uint64_t _corpus_random(Corpus* corpus, uint64_t bound) {
+  return _random_below(&corpus->seed, bound);
+}
+
+bool _corpus_chance(Corpus* corpus, unsigned int sixteenths) {
+  return _corpus_random(corpus, 16) < sixteenths;
+}
+
+void _corpus_append(Corpus* corpus, const char* text) {
+  size_t length = strlen(text);
+  if (corpus->length + length > corpus->capacity) {
+    corpus->capacity = (corpus->length + length) * 2;
+    corpus->data = realloc(corpus->data, corpus->capacity);
+  }
+
+  memcpy(corpus->data + corpus->length, text, length);
+  corpus->length += length;
+}
+
+void _corpus_pick(Corpus* corpus, const char** choices, size_t count) {
+  _corpus_append(corpus, choices[_corpus_random(corpus, count)]);
+}
+
+// Identifiers are drawn from a fixed vocabulary, as they would be in real
+// code, so that the symbol table sees mostly names it already knows.
+#define CORPUS_VOCABULARY  4096
+
+void _corpus_ident(Corpus* corpus) {
+  static const char* initial = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_";
+  static const char* rest = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+
+  // Each word's spelling is generated from its own seed.
+  uint64_t word = (_corpus_random(corpus, CORPUS_VOCABULARY) + 1) * 0x9E3779B97F4A7C15ULL;
+
+  char name[32];
+  size_t length = 1 + _random_below(&word, 20);
+  name[0] = initial[_random_below(&word, strlen(initial))];
+  for (size_t i = 1; i < length; i++) name[i] = rest[_random_below(&word, strlen(rest))];
+  name[length] = '\0';
+
+  _corpus_append(corpus, name);
+}
+
+void _corpus_digits(Corpus* corpus, const char* digits, size_t most) {
+  char text[64];
+  assert(most < sizeof(text));
+
+  size_t length = 1 + _corpus_random(corpus, most);
+  for (size_t i = 0; i < length; i++) text[i] = digits[_corpus_random(corpus, strlen(digits))];
+  text[length] = '\0';
+
+  _corpus_append(corpus, text);
+}
+
+void _corpus_literal(Corpus* corpus) {
+  switch (_corpus_random(corpus, 5)) {
+    case 0:
+      _corpus_digits(corpus, "0123456789", 12);
+      break;
+    case 1:
+      _corpus_append(corpus, "0x");
+      _corpus_digits(corpus, "0123456789abcdefABCDEF", 12);
+      break;
+    case 2:
+      _corpus_append(corpus, "0b");
+      _corpus_digits(corpus, "01", 24);
+      break;
+    case 3:
+      _corpus_digits(corpus, "0123456789", 6);
+      _corpus_append(corpus, ".");
+      _corpus_digits(corpus, "0123456789", 6);
+      break;
+    case 4:
+      _corpus_append(corpus, "\"");
+      _corpus_digits(corpus, "abcdefghijklmnopqrstuvwxyz ,.!?", 24);
+      _corpus_append(corpus, "\"");
+      break;
+  }
+}
+
+void _corpus_leaf(Corpus* corpus) {
+  const CorpusProfile* profile = corpus->profile;
+  if (_corpus_random(corpus, profile->identifiers + profile->literals) < profile->identifiers) {
+    _corpus_ident(corpus);
+  } else {
+    _corpus_literal(corpus);
+  }
+}
+
+void _corpus_newline(Corpus* corpus) {
+  if (_corpus_chance(corpus, corpus->profile->comments)) {
+    _corpus_append(corpus, " // ");
+    _corpus_digits(corpus, "abcdefghijklmnopqrstuvwxyz \"'(){}:=", 60);
+  }
+  _corpus_append(corpus, "\n");
+
+  for (size_t i = 0; i < corpus->indent; i++) _corpus_append(corpus, "  ");
+}
+
+void _corpus_expression(Corpus* corpus, size_t depth);
+
+// DECLARATION, in any of its three forms.
+void _corpus_declaration(Corpus* corpus, size_t depth) {
+  _corpus_ident(corpus);
+  switch (_corpus_random(corpus, 3)) {
+    case 0:
+      _corpus_append(corpus, " := ");
+      _corpus_expression(corpus, depth);
+      break;
+    case 1:
+      _corpus_append(corpus, " : ");
+      _corpus_ident(corpus);
+      _corpus_append(corpus, " = ");
+      _corpus_expression(corpus, depth);
+      break;
+    case 2:
+      _corpus_append(corpus, " : ");
+      _corpus_ident(corpus);
+      break;
+  }
+}
+
+// PROCEDURE_EXPR, with a few statements in its block; only the last of them
+// nests any further, so the size of the output is linear in the depth.
+void _corpus_procedure(Corpus* corpus, size_t depth) {
+  _corpus_append(corpus, "(");
+  size_t arguments = _corpus_random(corpus, 4);
+  for (size_t i = 0; i < arguments; i++) {
+    if (i > 0) _corpus_append(corpus, ", ");
+    _corpus_ident(corpus);
+    _corpus_append(corpus, " : ");
+    _corpus_ident(corpus);
+  }
+  _corpus_append(corpus, ") => {");
+
+  corpus->indent += 1;
+  size_t statements = 1 + _corpus_random(corpus, 3);
+  for (size_t i = 0; i < statements; i++) {
+    _corpus_newline(corpus);
+    if (_corpus_chance(corpus, 8)) {
+      _corpus_declaration(corpus, i + 1 == statements ? depth : 0);
+    } else {
+      _corpus_expression(corpus, i + 1 == statements ? depth : 0);
+    }
+  }
+  corpus->indent -= 1;
+
+  _corpus_newline(corpus);
+  _corpus_append(corpus, "}");
+}
+
+void _corpus_expression(Corpus* corpus, size_t depth) {
+  static const char* operators[] = { " + ", " - ", " * ", " / " };
+
+  if (depth == 0 || !_corpus_chance(corpus, corpus->profile->nesting)) {
+    _corpus_leaf(corpus);
+    return;
+  }
+
+  // Without operators, only procedures and calls are left.
+  uint64_t choice = _corpus_random(corpus, 4);
+  if (!corpus->profile->operators) choice = choice % 2 ? 3 : 0;
+
+  switch (choice) {
+    case 0:
+      _corpus_procedure(corpus, depth - 1);
+      break;
+    case 1:
+      _corpus_append(corpus, "(");
+      _corpus_expression(corpus, depth - 1);
+      _corpus_append(corpus, ")");
+      break;
+    case 2:
+      _corpus_leaf(corpus);
+      _corpus_pick(corpus, operators, sizeof(operators) / sizeof(operators[0]));
+      _corpus_expression(corpus, depth - 1);
+      break;
+    case 3: {
+      _corpus_ident(corpus);
+      _corpus_append(corpus, "(");
+      size_t arguments = _corpus_random(corpus, 4);
+      for (size_t i = 0; i < arguments; i++) {
+        if (i > 0) _corpus_append(corpus, ", ");
+        _corpus_expression(corpus, i + 1 == arguments ? depth - 1 : 0);
+      }
+      _corpus_append(corpus, ")");
+      break;
+    }
+  }
+}
+
+// Generates a NAMESPACE of top-level declarations at least `size` bytes long.
+String* generate_corpus(const CorpusProfile* profile, size_t size, uint64_t seed) {
+  Corpus corpus = { profile, seed | 1 };
+
+  while (corpus.length < size) {
+    _corpus_declaration(&corpus, profile->depth);
+    _corpus_newline(&corpus);
+  }
+
+  String* source = malloc(sizeof(String));
+  source->length = corpus.length;
+  source->data = corpus.data;
+  return source;
+}
+
+
+// ** Lexer Benchmarks ** //
+
+#define LEXER_BENCHMARK_SIZE  (16 << 20)
+#define LEXER_BENCHMARK_RUNS  5
+
+// Reports the fastest of several runs, after one to warm up (which also
+// interns every identifier, so that the timed runs all do the same work).
+void benchmark_tokenize_string(const CorpusProfile* profile) {
+  String* source = generate_corpus(profile, LEXER_BENCHMARK_SIZE, 0x5eed);
+  FileInfo file = { new_string("benchmark.xxx"), source };
+
+  TokenizedFile tokens;
+  tokenize_string(&file, &tokens);
+  size_t token_count = tokens.length;
+  free_tokenized_file(&tokens);
+
+  double fastest = 0;
+  for (size_t run = 0; run < LEXER_BENCHMARK_RUNS; run++) {
+    double start = __now();
+    tokenize_string(&file, &tokens);
+    double elapsed = __now() - start;
+
+    if (run == 0 || elapsed < fastest) fastest = elapsed;
+    free_tokenized_file(&tokens);
+  }
+
+  char name[64];
+  snprintf(name, sizeof(name), "tokenize_string: %s (16MB)", profile->name);
+  THROUGHPUT(name, fastest, source->length, token_count, "tokens");
+
+  // The source isn't freed, since interned symbols point into it.
+}
+
+void run_all_lexer_benchmarks() {
+  for (size_t i = 0; i < sizeof(CORPUS_PROFILES) / sizeof(CORPUS_PROFILES[0]); i++) {
+    benchmark_tokenize_string(&CORPUS_PROFILES[i]);
+  }
+}
@@ -0,0 +1,68 @@
+// Parser throughput over generated corpora (see `tests/benchmarks/lexer.c`),
+// restricted to the constructs the parser handles, so that every statement
+// parses cleanly.
+
+#define PARSER_BENCHMARK_SIZE  (8 << 20)
+#define PARSER_BENCHMARK_RUNS  5
+
+static const CorpusProfile PARSER_PROFILES[] = {
+  { "shallow",        12,  4,  0,  4,  3, 0 },
+  { "commented",      12,  4, 12,  4,  3, 0 },
+  { "deeply nested",   8,  8,  0, 15, 40, 0 },
+};
+
+// Parses the whole of `tokens` in a fresh workspace, returning the number of
+// statements which didn't parse.
+size_t _benchmark_parse(FileInfo* file, TokenizedFile* tokens) {
+  CompilationWorkspace ws = {0};
+  initialize_workspace(&ws);
+
+  Job job = { .type = JOB_PARSE, .ws = &ws, .file = file, .tokens = tokens };
+  perform_parse_job(&job);
+
+  size_t errors = 0;
+  while (pipeline_has_jobs(&ws)) {
+    Job* emitted = pipeline_take_job(&ws);
+    errors += emitted->type == JOB_ABORT;
+    pipeline_release_job(&ws, emitted);
+  }
+
+  // @Leak The workspace's tables and lists.
+  free_arena(&ws.arena);
+  return errors;
+}
+
+// Reports the fastest of several runs over the same tokens, after one to warm
+// up.  Lexing isn't timed.
+void benchmark_parse(const CorpusProfile* profile) {
+  String* source = generate_corpus(profile, PARSER_BENCHMARK_SIZE, 0x5eed);
+  FileInfo file = { new_string("benchmark.xxx"), source };
+
+  TokenizedFile tokens;
+  tokenize_string(&file, &tokens);
+
+  size_t errors = _benchmark_parse(&file, &tokens);
+  assert(errors == 0);
+
+  double fastest = 0;
+  for (size_t run = 0; run < PARSER_BENCHMARK_RUNS; run++) {
+    double start = __now();
+    _benchmark_parse(&file, &tokens);
+    double elapsed = __now() - start;
+
+    if (run == 0 || elapsed < fastest) fastest = elapsed;
+  }
+
+  char name[64];
+  snprintf(name, sizeof(name), "perform_parse_job: %s (8MB)", profile->name);
+  THROUGHPUT(name, fastest, source->length, tokens.length, "tokens");
+
+  free_tokenized_file(&tokens);
+  // The source isn't freed, since interned symbols point into it.
+}
+
+void run_all_parser_benchmarks() {
+  for (size_t i = 0; i < sizeof(PARSER_PROFILES) / sizeof(PARSER_PROFILES[0]); i++) {
+    benchmark_parse(&PARSER_PROFILES[i]);
+  }
+}
@@ -0,0 +1,120 @@
+// The bucketed queue that `Queue` replaced, kept here for comparison.
+typedef struct {
+  List list;
+  size_t position;
+} BucketQueue;
+
+void initialize_bucket_queue(BucketQueue* queue, size_t bucket_count, size_t bucket_size) {
+  initialize_list((List*) queue, bucket_count, bucket_size);
+  queue->position = 0;
+}
+
+void bucket_queue_add(BucketQueue* queue, void* value) {
+  list_append((List*) queue, value);
+}
+
+void* bucket_queue_pull(BucketQueue* queue) {
+  void* ptr = list_get((List*) queue, queue->position);
+  queue->position += 1;
+
+  if (queue->position == queue->list.bucket_size) {
+    queue->position = 0;
+    queue->list.length -= queue->list.bucket_size;
+    void** empty = queue->list.buckets[0];
+
+    size_t bucket_count = queue->list.capacity / queue->list.bucket_size;
+    for (int i = 0; i < bucket_count - 1; i++) {
+      queue->list.buckets[i] = queue->list.buckets[i + 1];
+    }
+    queue->list.buckets[bucket_count - 1] = empty;
+  }
+
+  return ptr;
+}
+
+
+#define QUEUE_BENCHMARK_ITEMS  (1 << 22)
+#define QUEUE_BENCHMARK_DEPTH  (1 << 17)  // BucketQueue is quadratic in depth.
+#define QUEUE_BENCHMARK_BATCH  64
+
+volatile size_t __queue_benchmark_sink;
+
+void benchmark_queue_fill_then_drain() {
+  size_t n = QUEUE_BENCHMARK_DEPTH;
+  size_t sum;
+
+  BucketQueue bucket_queue;
+  initialize_bucket_queue(&bucket_queue, 16, 16);
+  BENCHMARK("BucketQueue: fill, then drain (131072 deep)", 2 * n, {
+    sum = 0;
+    for (size_t i = 0; i < n; i++) bucket_queue_add(&bucket_queue, (void*) i);
+    for (size_t i = 0; i < n; i++) sum += (size_t) bucket_queue_pull(&bucket_queue);
+  });
+  __queue_benchmark_sink = sum;
+
+  Queue queue;
+  initialize_queue(&queue, 256);
+  BENCHMARK("Queue: fill, then drain (131072 deep)", 2 * n, {
+    sum = 0;
+    for (size_t i = 0; i < n; i++) queue_add(&queue, (void*) i);
+    for (size_t i = 0; i < n; i++) sum += (size_t) queue_pull(&queue);
+  });
+  __queue_benchmark_sink = sum;
+  free(queue.items);
+}
+
+// Mimics the pipeline, where each job pulled tends to emit another.
+void benchmark_queue_churn() {
+  size_t n = QUEUE_BENCHMARK_ITEMS;
+  size_t depth = 1024;
+  size_t sum;
+
+  BucketQueue bucket_queue;
+  initialize_bucket_queue(&bucket_queue, 16, 16);
+  for (size_t i = 0; i < depth; i++) bucket_queue_add(&bucket_queue, (void*) i);
+  BENCHMARK("BucketQueue: pull one, add one (1024 deep)", 2 * n, {
+    sum = 0;
+    for (size_t i = 0; i < n; i++) {
+      sum += (size_t) bucket_queue_pull(&bucket_queue);
+      bucket_queue_add(&bucket_queue, (void*) i);
+    }
+  });
+  __queue_benchmark_sink = sum;
+
+  Queue queue;
+  initialize_queue(&queue, 256);
+  for (size_t i = 0; i < depth; i++) queue_add(&queue, (void*) i);
+  BENCHMARK("Queue: pull one, add one (1024 deep)", 2 * n, {
+    sum = 0;
+    for (size_t i = 0; i < n; i++) {
+      sum += (size_t) queue_pull(&queue);
+      queue_add(&queue, (void*) i);
+    }
+  });
+  __queue_benchmark_sink = sum;
+  free(queue.items);
+}
+
+void benchmark_queue_batches() {
+  size_t n = QUEUE_BENCHMARK_DEPTH;
+  void* batch[QUEUE_BENCHMARK_BATCH];
+  size_t sum;
+
+  for (size_t i = 0; i < QUEUE_BENCHMARK_BATCH; i++) batch[i] = (void*) i;
+
+  Queue queue;
+  initialize_queue(&queue, 256);
+  BENCHMARK("Queue: add_n, then pull_n (131072 deep, batches of 64)", 2 * n, {
+    sum = 0;
+    for (size_t i = 0; i < n; i += QUEUE_BENCHMARK_BATCH) queue_add_n(&queue, batch, QUEUE_BENCHMARK_BATCH);
+    while (queue_pull_n(&queue, batch, QUEUE_BENCHMARK_BATCH) > 0) sum += (size_t) batch[0];
+  });
+  __queue_benchmark_sink = sum;
+  free(queue.items);
+}
+
+void run_all_queue_benchmarks() {
+  benchmark_queue_fill_then_drain();
+  benchmark_queue_churn();
+  benchmark_queue_batches();
+}
@@ -0,0 +1,233 @@
+// Streaming a file in chunks must produce exactly the same tokens as one pass.
+size_t _token_mismatches(TokenizedFile* a, TokenizedFile* b) {
+  if (a->length != b->length) return a->length > b->length ? a->length - b->length : b->length - a->length;
+
+  size_t mismatches = 0;
+  for (size_t i = 0; i < a->length; i++) {
+    mismatches += a->types[i] != b->types[i];
+    mismatches += a->flags[i] != b->flags[i];
+    mismatches += a->offsets[i] != b->offsets[i];
+    mismatches += a->lengths[i] != b->lengths[i];
+    mismatches += a->symbols[i] != b->symbols[i];
+  }
+
+  if (a->value_count != b->value_count) return mismatches + 1;
+  for (size_t i = 0; i < a->value_count; i++) {
+    mismatches += a->values[i] != b->values[i];
+    mismatches += a->value_tokens[i] != b->value_tokens[i];
+  }
+
+  return mismatches;
+}
+
+// Counts the held tokens which differ from the same tokens in `expected`.
+size_t _held_token_mismatches(TokenizedFile* tokens, TokenizedFile* expected) {
+  size_t mismatches = 0;
+  for (size_t i = tokens->base; i < tokens->base + tokens->length; i++) {
+    mismatches += token_type(tokens, i) != token_type(expected, i);
+    mismatches += token_offset(tokens, i) != token_offset(expected, i);
+    mismatches += token_literal_type(tokens, i) != token_literal_type(expected, i);
+    mismatches += token_symbol(tokens, i) != token_symbol(expected, i);
+
+    if (token_literal_type(tokens, i) & (IS_DECIMAL_LITERAL | IS_HEX_LITERAL | IS_BINARY_LITERAL)) {
+      mismatches += token_value(tokens, i) != token_value(expected, i);
+    }
+  }
+
+  return mismatches;
+}
+
+void test_streaming_lexing() {
+  TEST("Lexing a large file as a stream of chunks");
+
+  // Comment markers and quotes in awkward places, and lines of varied length,
+  // so that the chunk boundaries land somewhere different in every line.
+  char* lines[] = {
+    "x := \"a string // with a comment marker\"\n",
+    "// a comment with a \"quote\n",
+    "y : int = 0x1F + 0b101 * 3.25 // trailing\n",
+    "\n",
+    "  \"unterminated string\n",
+    "f := (a : int, b : string) => { return a }\n",
+    "@load \"other.xxx\"\n",
+  };
+  size_t line_count = sizeof(lines) / sizeof(lines[0]);
+
+  String* source = malloc(sizeof(String));
+  source->length = 0;
+  source->data = malloc(3 * LEX_CHUNK_SIZE + 1024);
+
+  for (size_t i = 0; source->length < 3 * LEX_CHUNK_SIZE; i++) {
+    char* line = lines[(i * 5) % line_count];
+    memcpy(source->data + source->length, line, strlen(line));
+    source->length += strlen(line);
+  }
+
+  FileInfo file = { new_string("test.xxx"), source };
+  TokenizedFile expected;
+  TokenizedFile actual;
+  Scheduler* scheduler = new_scheduler(3);
+
+  tokenize_string(&file, &expected);
+  tokenize_string_streaming(scheduler, &file, &actual);
+  while (tokenized_file_pull(&actual));
+  ASSERT_EQ(actual.length, expected.length, "produces the same number of tokens");
+  ASSERT_EQ(_token_mismatches(&actual, &expected), 0, "produces the same tokens");
+  ASSERT_EQ((actual.capacity & (actual.capacity - 1)), 0, "grows its columns geometrically as chunks arrive");
+  free_tokenized_file(&actual);
+
+  tokenize_string_streaming(NULL, &file, &actual);
+  while (tokenized_file_pull(&actual));
+  ASSERT_EQ(_token_mismatches(&actual, &expected), 0, "produces the same tokens without a scheduler");
+  free_tokenized_file(&actual);
+
+  // Discarding all but the last few tokens before each pull keeps the number
+  // held down to about a chunk's worth, without renumbering any of them.
+  size_t most_held = 0;
+  size_t mismatches = 0;
+  tokenize_string_streaming(scheduler, &file, &actual);
+  while (tokenized_file_pull(&actual)) {
+    mismatches += _held_token_mismatches(&actual, &expected);
+    if (actual.length > most_held) most_held = actual.length;
+    tokenized_file_discard(&actual, actual.base + actual.length - 10);
+  }
+  ASSERT_EQ(mismatches, 0, "keeps token numbers across discards");
+  ASSERT_EQ(actual.base + actual.length, expected.length, "streams every token");
+  ASSERT_EQ((most_held < expected.length / 2), 1, "holds only a chunk's tokens at a time");
+  free_tokenized_file(&actual);
+
+  // Without a trailing newline, the last chunk runs to the end of the input.
+  source->length -= 1;
+  free_tokenized_file(&expected);
+
+  tokenize_string(&file, &expected);
+  tokenize_string_streaming(scheduler, &file, &actual);
+  while (tokenized_file_pull(&actual));
+  ASSERT_EQ(_token_mismatches(&actual, &expected), 0, "handles input without a trailing newline");
+
+  free_tokenized_file(&expected);
+  free_tokenized_file(&actual);
+  free_scheduler(scheduler);
+}
+
+// Integer literals must evaluate the same whether or not any digits are
+// converted eight at a time.
+size_t _literal_mismatches(bool (*parse)(const char*, size_t, uint64_t*), int base, const char* digits, unsigned int seed) {
+  char data[48];
+  char stripped[48];
+  size_t mismatches = 0;
+  srand(seed);
+
+  for (size_t length = 1; length < sizeof(data); length++) {
+    for (size_t trial = 0; trial < 64; trial++) {
+      size_t stripped_length = 0;
+      for (size_t i = 0; i < length; i++) {
+        data[i] = digits[rand() % strlen(digits)];
+        if (data[i] != '_') stripped[stripped_length++] = data[i];
+      }
+      stripped[stripped_length] = '\0';
+
+      errno = 0;
+      uint64_t expected = strtoull(stripped, NULL, base);
+      bool expected_fits = errno != ERANGE;
+
+      uint64_t actual;
+      bool fits = parse(data, length, &actual);
+
+      mismatches += fits != expected_fits;
+      mismatches += fits && actual != expected;
+    }
+  }
+
+  return mismatches;
+}
+
+void test_integer_literals() {
+  TEST("Evaluating integer literals");
+
+  ASSERT_EQ(_literal_mismatches(parse_decimal_literal, 10, "0123456789", 1), 0, "evaluates decimal literals");
+  ASSERT_EQ(_literal_mismatches(parse_decimal_literal, 10, "0019", 2), 0, "evaluates decimal literals with leading zeros");
+  ASSERT_EQ(_literal_mismatches(parse_hex_literal, 16, "0123456789abcdefABCDEF", 3), 0, "evaluates hex literals");
+  ASSERT_EQ(_literal_mismatches(parse_hex_literal, 16, "000f", 4), 0, "evaluates hex literals with leading zeros");
+  ASSERT_EQ(_literal_mismatches(parse_binary_literal, 2, "01", 5), 0, "evaluates binary literals");
+  ASSERT_EQ(_literal_mismatches(parse_decimal_literal, 10, "0123456789__________", 6), 0, "skips separators in decimal literals");
+  ASSERT_EQ(_literal_mismatches(parse_hex_literal, 16, "0123456789abcdefABCDEF______", 7), 0, "skips separators in hex literals");
+  ASSERT_EQ(_literal_mismatches(parse_binary_literal, 2, "01_", 8), 0, "skips separators in binary literals");
+
+  uint64_t value;
+  ASSERT_EQ(parse_decimal_literal("18446744073709551615", 20, &value), 1, "accepts the largest 64-bit value");
+  ASSERT_EQ(value, UINT64_MAX, "evaluates the largest 64-bit value");
+  ASSERT_EQ(parse_decimal_literal("18446744073709551616", 20, &value), 0, "rejects values past 64 bits");
+}
+
+void test_utf8_validation() {
+  TEST("Validating UTF-8");
+  const Scanners* scan = select_scanners();
+
+  char* ascii = "plain old ASCII, long enough to need a few vectors of it";
+  ASSERT_EQ(utf8_validate(scan, ascii, 0, strlen(ascii)), strlen(ascii), "accepts ASCII");
+
+  char* mixed = "caf\xc3\xa9 \xe2\x80\x94 \xf0\x9f\x98\x80 and then some more ASCII";
+  ASSERT_EQ(utf8_validate(scan, mixed, 0, strlen(mixed)), strlen(mixed), "accepts two, three and four byte sequences");
+
+  char* stray = "an ordinary line of text with a stray \x80 continuation byte";
+  ASSERT_EQ(utf8_validate(scan, stray, 0, strlen(stray)), 38, "finds a stray continuation byte");
+
+  char* overlong = "ab\xe0\x80\xaf" "cd";
+  ASSERT_EQ(utf8_validate(scan, overlong, 0, strlen(overlong)), 2, "rejects overlong encodings");
+
+  char* overlong_lead = "ab\xc0\xaf" "cd";
+  ASSERT_EQ(utf8_validate(scan, overlong_lead, 0, strlen(overlong_lead)), 2, "rejects lead bytes which are always overlong");
+
+  char* surrogate = "abc\xed\xa0\x80";
+  ASSERT_EQ(utf8_validate(scan, surrogate, 0, strlen(surrogate)), 3, "rejects surrogates");
+
+  char* truncated = "abcd\xe2\x80";
+  ASSERT_EQ(utf8_validate(scan, truncated, 0, strlen(truncated)), 4, "rejects sequences cut short");
+}
+
+void test_unicode_identifiers() {
+  TEST("Classifying Unicode identifier characters");
+
+  ASSERT_EQ(unicode_identifier_length("\xc3\xa9", 0, 2, 1), 2, "accepts accented letters");
+  ASSERT_EQ(unicode_identifier_length("\xe4\xb8\xad", 0, 3, 1), 3, "accepts CJK ideographs");
+  ASSERT_EQ(unicode_identifier_length("\xe2\x80\x94", 0, 3, 1), 0, "rejects punctuation");
+  ASSERT_EQ(unicode_identifier_length("\xcc\x81", 0, 2, 1), 0, "rejects combining marks at the start");
+  ASSERT_EQ(unicode_identifier_length("\xcc\x81", 0, 2, 0), 2, "accepts combining marks later on");
+  ASSERT_EQ(unicode_identifier_length("\xc3", 0, 1, 0), 0, "rejects invalid UTF-8");
+}
+
+void test_seeded_symbols() {
+  TEST("Lexing seeded symbols");
+
+  String* source = new_string("f(a, b) {\n  return a := b\n}\n");
+  TokenizedFile tokens;
+  initialize_tokenized_file(&tokens, source);
+  tokenize_range(source, 0, source->length, &tokens);
+
+  size_t mismatches = 0;
+  for (size_t i = 0; i < tokens.length; i++) {
+    String text = token_source(&tokens, i);
+    mismatches += token_symbol(&tokens, i) != symbol_get(&text);
+  }
+  ASSERT_EQ(mismatches, 0, "gives every token the symbol for its text");
+
+  ASSERT_EQ(token_symbol(&tokens, 1), OP_OPEN_PAREN, "recognizes open parens");
+  ASSERT_EQ(token_symbol(&tokens, 3), OP_COMMA, "recognizes commas");
+  ASSERT_EQ(token_symbol(&tokens, 5), OP_CLOSE_PAREN, "recognizes close parens");
+  ASSERT_EQ(token_symbol(&tokens, 6), OP_OPEN_BRACE, "recognizes open braces");
+  ASSERT_EQ(token_symbol(&tokens, 7), OP_NEWLINE, "recognizes newlines");
+  ASSERT_EQ(token_symbol(&tokens, 8), KEYWORD_RETURN, "recognizes keywords");
+  ASSERT_EQ(token_symbol(&tokens, 10), OP_DECLARE_ASSIGN, "recognizes multi-character operators");
+  ASSERT_EQ(token_symbol(&tokens, 13), OP_CLOSE_BRACE, "recognizes close braces");
+
+  free_tokenized_file(&tokens);
+}
+
+void run_all_lexer_tests() {
+  test_streaming_lexing();
+  test_seeded_symbols();
+  test_integer_literals();
+  test_utf8_validation();
+  test_unicode_identifiers();
+}
@@ -1,5 +1,7 @@
 #define TESTING 1
 
+#include <errno.h>
+
 #include "src/main.c"
 
 int __tests_run = 0;
@@ -15,6 +17,11 @@ int __failed_assertions = 0;
 #include "tests/table.c"
 #include "tests/list.c"
 #include "tests/pool.c"
+#include "tests/arena.c"
+#include "tests/queue.c"
+#include "tests/atomic_queue.c"
+#include "tests/scan.c"
+#include "tests/lexer.c"
 
 int main() {
   printf("\nTABLE TESTS\n");
@@ -26,6 +33,21 @@ int main() {
   printf("\nPOOL TESTS\n");
   run_all_pool_tests();
 
+  printf("\nARENA TESTS\n");
+  run_all_arena_tests();
+
+  printf("\nQUEUE TESTS\n");
+  run_all_queue_tests();
+
+  printf("\nATOMIC QUEUE TESTS\n");
+  run_all_atomic_queue_tests();
+
+  printf("\nSCAN TESTS\n");
+  run_all_scan_tests();
+
+  printf("\nLEXER TESTS\n");
+  run_all_lexer_tests();
+
   printf("\n\e[0;32m%d\e[0m tests, \e[0;32m%d\e[0m assertions, \e[0;31m%d\e[0m failures\n", __tests_run, __assertions, __failed_assertions);
   return 0;
 }
@@ -137,11 +137,12 @@ void test_pool_to_array() {
 
   // Pool now has a length of 7, but has 9 bucket slots allocated.
 
+  // The array only has room for the occupied slots, so copying any others would
+  // overrun it; run the tests under ASan to catch that.
   TEST("Converting a multi-byte pool to an array of bytes omits unoccupied bucket slots");
   c = pool_to_array(pool);
   ASSERT_EQ(strcmp(c, "hello!"), 0, "correctly returns a byte sequence as a unified array");
-  ASSERT_NOT_EQ(c[7], '\xFF', "does not copy slot 7 into the new array");
-  ASSERT_NOT_EQ(c[8], '\xFF', "does not copy slot 8 into the new array");
+  ASSERT_EQ(c[6], '\0', "copies the occupied slot of a partly filled bucket");
   free_pool(pool);
   free(c);
 
@@ -152,13 +153,11 @@ void test_pool_to_array() {
   *((char*) pool->buckets[1]) = '\xFF';
   *((char*) pool->buckets[2]) = '\xFF';
 
-  // Pool now has a length of 7, but has 9 bucket slots allocated.
+  // Pool now has a length of 1, but has 3 bucket slots allocated.
 
   TEST("Converting a multi-byte pool to an array of bytes omits unoccupied buckets");
   c = pool_to_array(pool);
   ASSERT_EQ(c[0], '#', "correctly returns the relevant bytes");
-  ASSERT_NOT_EQ(c[1], '\xFF', "does not copy slot 1 into the new array");
-  ASSERT_NOT_EQ(c[2], '\xFF', "does not copy slot 2 into the new array");
   free_pool(pool);
   free(c);
 }
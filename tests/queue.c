@@ -0,0 +1,110 @@
+void test_queue_creation() {
+  Queue* queue;
+
+  TEST("Creating a new queue(16)");
+  queue = new_queue(16);
+  ASSERT_EQ(queue_length(queue), 0, "has a length of zero");
+  ASSERT_EQ(queue->capacity, 16, "has 16 slots capacity");
+  free_queue(queue);
+
+  TEST("Creating a new queue(5)");
+  queue = new_queue(5);
+  ASSERT_EQ(queue_length(queue), 0, "has a length of zero");
+  ASSERT_EQ(queue->capacity, 8, "rounds capacity up to 8 slots");
+  free_queue(queue);
+}
+
+void test_queue_add_and_pull() {
+  Queue* queue;
+  size_t values[8] = {};
+
+  TEST("Adding and pulling items from a queue(4)");
+  queue = new_queue(4);
+  queue_add(queue, &values[0]);
+  queue_add(queue, &values[1]);
+  queue_add(queue, &values[2]);
+  ASSERT_EQ(queue_length(queue), 3, "has a length of 3");
+  ASSERT_EQ(queue_pull(queue), (void*) &values[0], "returns the value added first");
+  ASSERT_EQ(queue_pull(queue), (void*) &values[1], "returns the value added second");
+  ASSERT_EQ(queue_length(queue), 1, "has a length of 1");
+  free_queue(queue);
+
+  TEST("Wrapping around the end of a queue(4)");
+  queue = new_queue(4);
+  queue_add(queue, &values[0]);
+  queue_add(queue, &values[1]);
+  queue_add(queue, &values[2]);
+  queue_pull(queue);
+  queue_pull(queue);
+  queue_add(queue, &values[3]);
+  queue_add(queue, &values[4]);
+  queue_add(queue, &values[5]);
+  ASSERT_EQ(queue_length(queue), 4, "has a length of 4");
+  ASSERT_EQ(queue->capacity, 4, "has 4 slots capacity");
+  ASSERT_EQ(queue_pull(queue), (void*) &values[2], "returns the oldest value");
+  ASSERT_EQ(queue_pull(queue), (void*) &values[3], "returns the next value");
+  ASSERT_EQ(queue_pull(queue), (void*) &values[4], "returns the next value");
+  ASSERT_EQ(queue_pull(queue), (void*) &values[5], "returns the newest value");
+  free_queue(queue);
+
+  TEST("Growing a wrapped queue(4)");
+  queue = new_queue(4);
+  queue_add(queue, &values[0]);
+  queue_add(queue, &values[1]);
+  queue_add(queue, &values[2]);
+  queue_pull(queue);
+  queue_pull(queue);
+  queue_add(queue, &values[3]);
+  queue_add(queue, &values[4]);
+  queue_add(queue, &values[5]);
+  queue_add(queue, &values[6]);
+  ASSERT_EQ(queue_length(queue), 5, "has a length of 5");
+  ASSERT_EQ(queue->capacity, 8, "has 8 slots capacity");
+  ASSERT_EQ(queue_pull(queue), (void*) &values[2], "preserves the order of the values");
+  ASSERT_EQ(queue_pull(queue), (void*) &values[3], "preserves the order of the values");
+  ASSERT_EQ(queue_pull(queue), (void*) &values[4], "preserves the order of the values");
+  ASSERT_EQ(queue_pull(queue), (void*) &values[5], "preserves the order of the values");
+  ASSERT_EQ(queue_pull(queue), (void*) &values[6], "preserves the order of the values");
+  free_queue(queue);
+}
+
+void test_queue_batches() {
+  Queue* queue;
+  size_t values[8] = {};
+  void* batch[8] = { &values[0], &values[1], &values[2], &values[3], &values[4], &values[5], &values[6], &values[7] };
+  void* pulled[8] = {};
+
+  TEST("Adding a batch of items to a wrapped queue(4)");
+  queue = new_queue(4);
+  queue_add(queue, NULL);
+  queue_add(queue, NULL);
+  queue_add(queue, NULL);
+  queue_pull(queue);
+  queue_pull(queue);
+  queue_pull(queue);
+  queue_add_n(queue, batch, 3);
+  ASSERT_EQ(queue_length(queue), 3, "has a length of 3");
+  ASSERT_EQ(queue->capacity, 4, "has 4 slots capacity");
+  ASSERT_EQ(queue_pull(queue), (void*) &values[0], "returns the first value in the batch");
+  ASSERT_EQ(queue_pull(queue), (void*) &values[1], "returns the second value in the batch");
+  ASSERT_EQ(queue_pull(queue), (void*) &values[2], "returns the third value in the batch");
+  queue_add_n(queue, batch, 8);
+  ASSERT_EQ(queue_length(queue), 8, "has a length of 8");
+  ASSERT_EQ(queue->capacity, 8, "grows to 8 slots capacity");
+
+  TEST("Pulling a batch of items from a queue");
+  ASSERT_EQ(queue_pull_n(queue, pulled, 5), 5, "pulls the requested number of items");
+  ASSERT_EQ(pulled[0], (void*) &values[0], "returns the first value");
+  ASSERT_EQ(pulled[4], (void*) &values[4], "returns the fifth value");
+  ASSERT_EQ(queue_pull_n(queue, pulled, 5), 3, "pulls only the remaining items");
+  ASSERT_EQ(pulled[0], (void*) &values[5], "returns the sixth value");
+  ASSERT_EQ(pulled[2], (void*) &values[7], "returns the last value");
+  ASSERT_EQ(queue_length(queue), 0, "leaves the queue empty");
+  free_queue(queue);
+}
+
+void run_all_queue_tests() {
+  test_queue_creation();
+  test_queue_add_and_pull();
+  test_queue_batches();
+}
@@ -4,6 +4,16 @@ tests="$(dirname "$0")"
 
 results=$(mktemp -d "${TMPDIR:-/tmp/}$(basename 0).XXXXXXXXXXXX")
 
+entry="$tests/compilation/003-execution/001-entry-point.xxx"
+echo "Checking instructions retired by $entry"
+
+$1 --stats=json "$entry" 2>&1 >/dev/null | grep -q '"instructions_retired": [1-9]' || {
+  echo ""
+  echo "Failed test $entry"
+  echo "Running the entry point didn't retire any instructions."
+  exit 1
+}
+
 for test in $(find "$tests/compilation" -not -type d | sort); do
   mkdir -p "$results/$test"
   rmdir "$results/$test"
@@ -0,0 +1,65 @@
+// Every scanner must agree with the scalar version, from every starting point.
+size_t _scan_mismatches(const Scanners* scanners, const char* data, size_t length) {
+  size_t mismatches = 0;
+
+  for (size_t pos = 0; pos <= length; pos++) {
+    mismatches += scanners->whitespace(data, pos, length) != scan_whitespace_scalar(data, pos, length);
+    mismatches += scanners->identifier(data, pos, length) != scan_identifier_scalar(data, pos, length);
+    mismatches += scanners->string(data, pos, length) != scan_string_scalar(data, pos, length);
+    mismatches += scanners->line(data, pos, length) != scan_line_scalar(data, pos, length);
+    mismatches += scanners->ascii(data, pos, length) != scan_ascii_scalar(data, pos, length);
+  }
+
+  return mismatches;
+}
+
+void _fill_scan_input(char* data, size_t length, const char* alphabet, unsigned int seed) {
+  size_t alphabet_length = strlen(alphabet);
+  srand(seed);
+
+  for (size_t i = 0; i < length; i++) {
+    // Mostly long runs of one class, with the occasional arbitrary byte.
+    if (rand() % 16 == 0) {
+      data[i] = (char) (rand() % 256);
+    } else {
+      data[i] = alphabet[rand() % alphabet_length];
+    }
+  }
+}
+
+void _test_scanners(const Scanners* scanners) {
+  char data[300];
+  size_t length = sizeof(data);
+
+  _fill_scan_input(data, length, " \t\r", 1);
+  ASSERT_EQ(_scan_mismatches(scanners, data, length), 0, "agrees with the scalar version on whitespace");
+
+  _fill_scan_input(data, length, "abcxyzABCXYZ0189_", 2);
+  ASSERT_EQ(_scan_mismatches(scanners, data, length), 0, "agrees with the scalar version on identifiers");
+
+  _fill_scan_input(data, length, "abc \\\"\n/@`[{", 3);
+  ASSERT_EQ(_scan_mismatches(scanners, data, length), 0, "agrees with the scalar version on mixed input");
+
+  memset(data, 'a', length);
+  ASSERT_EQ(scanners->identifier(data, 0, length), length, "runs to the end of the input");
+  ASSERT_EQ(scanners->line(data, 5, 37), 37, "never scans past the given length");
+}
+
+void test_scanners() {
+#if defined(__x86_64__)
+  TEST("Scanning with SSE2");
+  _test_scanners(&SSE2Scanners);
+
+  if (__builtin_cpu_supports("avx2")) {
+    TEST("Scanning with AVX2");
+    _test_scanners(&AVX2Scanners);
+  }
+#endif
+
+  TEST("Scanning with the selected scanners");
+  _test_scanners(select_scanners());
+}
+
+void run_all_scan_tests() {
+  test_scanners();
+}
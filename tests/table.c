@@ -95,8 +95,34 @@ void test_table_find() {
   free_table(t);
 }
 
+void test_id_table() {
+  IdTable t;
+  char values[100];
+
+  TEST("Adding and finding items in an id table(4)");
+  initialize_id_table(&t, 4);
+  ASSERT_EQ(id_table_find(&t, 0), NULL, "returns NULL for a missing id");
+
+  for (uint32_t i = 0; i < 100; i++) id_table_add(&t, i * 7, &values[i]);
+  ASSERT_EQ(t.size, 100, "has a size of one hundred");
+  ASSERT_EQ(t.capacity, 256, "grows to 256 slots capacity");
+
+  size_t misses = 0;
+  for (uint32_t i = 0; i < 100; i++) misses += id_table_find(&t, i * 7) != &values[i];
+  ASSERT_EQ(misses, 0, "returns the associated values");
+  ASSERT_EQ(id_table_find(&t, 1), NULL, "returns NULL for an id between others");
+  ASSERT_EQ(id_table_find(&t, UINT32_MAX), NULL, "returns NULL for the largest id");
+
+  TEST("Clearing an item in an id table");
+  id_table_add(&t, 14, NULL);
+  ASSERT_EQ(id_table_find(&t, 14), NULL, "returns NULL");
+  ASSERT_EQ(t.size, 100, "keeps its size");
+  free_id_table(&t);
+}
+
 void run_all_table_tests() {
   test_table_creation();
   test_table_add();
   test_table_find();
+  test_id_table();
 }